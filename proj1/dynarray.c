@@ -76,6 +76,25 @@ void _dynarray_resize(struct dynarray* da, int new_capacity) {
 }
 
 
+void dynarray_reserve(struct dynarray* da, int capacity) {
+  assert(da);
+  if (capacity > da->capacity) {
+    _dynarray_resize(da, capacity);
+  }
+}
+
+
+void dynarray_resize(struct dynarray* da, int size) {
+  assert(da);
+  assert(size >= 0);
+  dynarray_reserve(da, size);
+  for (int i = da->size; i < size; i++) {
+    da->data[i] = NULL;
+  }
+  da->size = size;
+}
+
+
 void dynarray_insert(struct dynarray* da, int idx, void* val) {
   assert(da);
   assert((idx <= da->size && idx >= 0) || idx == -1);
@@ -34,6 +34,26 @@ void dynarray_free(struct dynarray* da);
  */
 int dynarray_size(struct dynarray* da);
 
+/*
+ * Makes sure a dynamic array can hold at least a given number of elements
+ * without reallocating its storage.  The size of the array is unchanged.
+ *
+ * Params:
+ *   da - the dynamic array to grow.  May not be NULL.
+ *   capacity - the number of elements the array should be able to hold.
+ */
+void dynarray_reserve(struct dynarray* da, int capacity);
+
+/*
+ * Changes the size of a dynamic array.  Elements added at the end of the
+ * array are set to NULL, and elements beyond the new size are dropped.
+ *
+ * Params:
+ *   da - the dynamic array to resize.  May not be NULL.
+ *   size - the new size of the array.  Must not be negative.
+ */
+void dynarray_resize(struct dynarray* da, int size);
+
 /*
  * Inserts a new element to a dynamic array at a specified index.  All existing
  * elements following the specified index are moved back to make room for the
@@ -0,0 +1,325 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a GPA quantile sketch using the KLL algorithm (Karnin, Lang and Liberty).
+ *
+ * The sketch is a stack of compactors.  Every GPA in level h stands for 2^h
+ * original GPAs.  When the sketch grows past its capacity, the lowest level
+ * that is over its own capacity is sorted and every other item (starting at a
+ * randomly chosen offset) is promoted to the level above, halving the level
+ * while keeping its ranks unbiased.  Level capacities shrink geometrically
+ * towards the bottom, so the total size stays around 3k.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <assert.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "gpa_sketch.h"
+#include "student_ingest.h"
+
+#define GPA_SKETCH_MIN_K 8
+
+/*
+ * This is a single compactor: a growable array of GPAs of equal weight.
+ * cap is the allocated size of items, and limit is the number of items the
+ * level may hold before it gets compacted.
+ */
+struct sketch_level {
+  float* items;
+  int size;
+  int cap;
+  int limit;
+};
+
+/*
+ * This is the definition of the sketch structure.  total_limit is the sum of
+ * the limits of all levels.  rng is the state of the generator that picks
+ * compaction offsets; it is seeded with a constant so that results are
+ * reproducible.
+ */
+struct gpa_sketch {
+  int k;
+  struct sketch_level* levels;
+  int num_levels;
+  int total_size;
+  int total_limit;
+  long long count;
+  float min;
+  float max;
+  uint64_t rng;
+};
+
+/*
+ * This is an item of a sketch along with its weight, used to answer
+ * quantile queries.
+ */
+struct sketch_item {
+  float gpa;
+  long long weight;
+};
+
+
+/*
+ * Auxilliary function returning one pseudo-random bit (xorshift64).
+ */
+static int _sketch_random_bit(struct gpa_sketch* sketch) {
+  sketch->rng ^= sketch->rng << 13;
+  sketch->rng ^= sketch->rng >> 7;
+  sketch->rng ^= sketch->rng << 17;
+  return (int)(sketch->rng >> 63);
+}
+
+
+/*
+ * Auxilliary function to recompute the limit of every level, which is k for
+ * the top level and shrinks by a factor of 2/3 for every level below it.
+ * Limits only depend on the number of levels, so this only needs to run when
+ * a level is added.
+ */
+static void _sketch_update_limits(struct gpa_sketch* sketch) {
+  sketch->total_limit = 0;
+  for (int h = 0; h < sketch->num_levels; h++) {
+    int depth = sketch->num_levels - 1 - h;
+    int limit = (int)ceil(sketch->k * pow(2.0 / 3.0, depth));
+    sketch->levels[h].limit = limit < 2 ? 2 : limit;
+    sketch->total_limit += sketch->levels[h].limit;
+  }
+}
+
+
+/*
+ * Auxilliary function to make sure level h exists.
+ */
+static void _sketch_ensure_level(struct gpa_sketch* sketch, int h) {
+  if (h < sketch->num_levels) {
+    return;
+  }
+  sketch->levels = realloc(sketch->levels,
+    (h + 1) * sizeof(struct sketch_level));
+  assert(sketch->levels);
+  for (int i = sketch->num_levels; i <= h; i++) {
+    sketch->levels[i].items = NULL;
+    sketch->levels[i].size = 0;
+    sketch->levels[i].cap = 0;
+  }
+  sketch->num_levels = h + 1;
+  _sketch_update_limits(sketch);
+}
+
+
+/*
+ * Auxilliary function to append a GPA to level h.
+ */
+static void _sketch_level_push(struct gpa_sketch* sketch, int h, float gpa) {
+  struct sketch_level* level = &sketch->levels[h];
+  if (level->size == level->cap) {
+    level->cap = level->cap ? 2 * level->cap : 8;
+    level->items = realloc(level->items, level->cap * sizeof(float));
+    assert(level->items);
+  }
+  level->items[level->size++] = gpa;
+  sketch->total_size++;
+}
+
+
+static int _sketch_compare_floats(const void* a, const void* b) {
+  float x = *(const float*)a, y = *(const float*)b;
+  return (x > y) - (x < y);
+}
+
+
+/*
+ * Auxilliary function to compact level h into level h + 1.  If the level
+ * holds an odd number of items, its largest item stays behind.
+ */
+static void _sketch_compact(struct gpa_sketch* sketch, int h) {
+  _sketch_ensure_level(sketch, h + 1);
+  struct sketch_level* level = &sketch->levels[h];
+  qsort(level->items, level->size, sizeof(float), _sketch_compare_floats);
+
+  int pairs = level->size / 2;
+  int offset = _sketch_random_bit(sketch);
+  for (int i = 0; i < pairs; i++) {
+    _sketch_level_push(sketch, h + 1, sketch->levels[h].items[2 * i + offset]);
+  }
+
+  level = &sketch->levels[h];
+  if (level->size % 2) {
+    level->items[0] = level->items[level->size - 1];
+  }
+  sketch->total_size -= 2 * pairs;
+  level->size %= 2;
+}
+
+
+/*
+ * Auxilliary function to compact levels until the sketch fits within its
+ * total limit.
+ */
+static void _sketch_compress(struct gpa_sketch* sketch) {
+  while (sketch->total_size >= sketch->total_limit) {
+    for (int h = 0; h < sketch->num_levels; h++) {
+      if (sketch->levels[h].size >= sketch->levels[h].limit) {
+        _sketch_compact(sketch, h);
+        break;
+      }
+    }
+  }
+}
+
+
+struct gpa_sketch* gpa_sketch_create(int k) {
+  struct gpa_sketch* sketch = malloc(sizeof(struct gpa_sketch));
+  assert(sketch);
+  sketch->k = k < GPA_SKETCH_MIN_K ? GPA_SKETCH_MIN_K : k;
+  sketch->levels = NULL;
+  sketch->num_levels = 0;
+  sketch->total_size = 0;
+  sketch->count = 0;
+  sketch->min = sketch->max = 0.0f;
+  sketch->rng = UINT64_C(0x9E3779B97F4A7C15);
+  _sketch_ensure_level(sketch, 0);
+  return sketch;
+}
+
+
+void gpa_sketch_free(struct gpa_sketch* sketch) {
+  assert(sketch);
+  for (int h = 0; h < sketch->num_levels; h++) {
+    free(sketch->levels[h].items);
+  }
+  free(sketch->levels);
+  free(sketch);
+}
+
+
+void gpa_sketch_add(struct gpa_sketch* sketch, float gpa) {
+  assert(sketch);
+  if (sketch->count == 0 || gpa < sketch->min) {
+    sketch->min = gpa;
+  }
+  if (sketch->count == 0 || gpa > sketch->max) {
+    sketch->max = gpa;
+  }
+  sketch->count++;
+
+  _sketch_level_push(sketch, 0, gpa);
+  if (sketch->total_size >= sketch->total_limit) {
+    _sketch_compress(sketch);
+  }
+}
+
+
+void gpa_sketch_add_students(struct gpa_sketch* sketch,
+    struct dynarray* students) {
+  assert(sketch && students);
+  int n = dynarray_size(students);
+  for (int i = 0; i < n; i++) {
+    gpa_sketch_add(sketch, ((struct student*)dynarray_get(students, i))->gpa);
+  }
+}
+
+
+void gpa_sketch_merge(struct gpa_sketch* into, struct gpa_sketch* from) {
+  assert(into && from);
+  if (from->count == 0) {
+    return;
+  }
+
+  if (into->count == 0 || from->min < into->min) {
+    into->min = from->min;
+  }
+  if (into->count == 0 || from->max > into->max) {
+    into->max = from->max;
+  }
+  into->count += from->count;
+
+  /*
+   * Items keep their weight, so each level of from is appended to the same
+   * level of into.  Capacities are then restored by compacting.
+   */
+  _sketch_ensure_level(into, from->num_levels - 1);
+  for (int h = 0; h < from->num_levels; h++) {
+    for (int i = 0; i < from->levels[h].size; i++) {
+      _sketch_level_push(into, h, from->levels[h].items[i]);
+    }
+  }
+  _sketch_compress(into);
+}
+
+
+long long gpa_sketch_count(struct gpa_sketch* sketch) {
+  assert(sketch);
+  return sketch->count;
+}
+
+
+static int _sketch_compare_items(const void* a, const void* b) {
+  float x = ((const struct sketch_item*)a)->gpa;
+  float y = ((const struct sketch_item*)b)->gpa;
+  return (x > y) - (x < y);
+}
+
+
+float gpa_sketch_quantile(struct gpa_sketch* sketch, double q) {
+  assert(sketch && sketch->count > 0 && q >= 0.0 && q <= 1.0);
+  if (q == 0.0) {
+    return sketch->min;
+  }
+  if (q == 1.0) {
+    return sketch->max;
+  }
+
+  struct sketch_item* items =
+    malloc(sketch->total_size * sizeof(struct sketch_item));
+  assert(items);
+  int n = 0;
+  long long total_weight = 0;
+  for (int h = 0; h < sketch->num_levels; h++) {
+    for (int i = 0; i < sketch->levels[h].size; i++) {
+      items[n].gpa = sketch->levels[h].items[i];
+      items[n].weight = 1LL << h;
+      total_weight += items[n].weight;
+      n++;
+    }
+  }
+  qsort(items, n, sizeof(struct sketch_item), _sketch_compare_items);
+
+  /*
+   * Return the first item whose cumulative weight reaches the target rank.
+   */
+  double target = q * total_weight;
+  float result = items[n - 1].gpa;
+  long long cumulative = 0;
+  for (int i = 0; i < n; i++) {
+    cumulative += items[i].weight;
+    if (cumulative >= target) {
+      result = items[i].gpa;
+      break;
+    }
+  }
+
+  free(items);
+  return result;
+}
+
+
+/*
+ * Auxilliary function adding a student's GPA to the sketch passed as arg.
+ * It is used as the ingest hook of create_student_array_with_sketch().
+ */
+static int _gpa_sketch_ingest(struct student* student, void* arg) {
+  gpa_sketch_add(arg, student->gpa);
+  return 1;
+}
+
+
+struct dynarray* create_student_array_with_sketch(int num_students,
+    char** names, int* ids, float* gpas, struct gpa_sketch* sketch) {
+  assert(sketch);
+  return create_student_array_with_hook(num_students, names, ids, gpas,
+    _gpa_sketch_ingest, sketch);
+}
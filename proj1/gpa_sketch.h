@@ -0,0 +1,92 @@
+/*
+ * This file contains the definition of an interface for a streaming quantile
+ * sketch over student GPAs.  The sketch summarizes any number of GPAs in a
+ * small, bounded amount of memory and answers approximate quantile queries
+ * (e.g. the median or 99th percentile GPA).  Sketches built separately, for
+ * example by parallel loaders, can be merged.
+ */
+
+#ifndef __GPA_SKETCH_H
+#define __GPA_SKETCH_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * The default accuracy parameter.  With k = 200, the rank error of a
+ * quantile is typically well under 1% of the number of GPAs added.
+ */
+#define GPA_SKETCH_DEFAULT_K 200
+
+/*
+ * Structure used to represent a GPA sketch.
+ */
+struct gpa_sketch;
+
+/*
+ * Creates a new, empty GPA sketch and returns a pointer to it.
+ *
+ * Params:
+ *   k - the accuracy parameter.  Larger values use more memory (about 3k
+ *     GPAs) and give more accurate quantiles.  Values below 8 are rounded up
+ *     to 8.
+ */
+struct gpa_sketch* gpa_sketch_create(int k);
+
+/*
+ * Free the memory associated with a GPA sketch.
+ *
+ * Params:
+ *   sketch - the sketch to be destroyed.  May not be NULL.
+ */
+void gpa_sketch_free(struct gpa_sketch* sketch);
+
+/*
+ * Adds one GPA to a sketch.
+ */
+void gpa_sketch_add(struct gpa_sketch* sketch, float gpa);
+
+/*
+ * Adds the GPAs of every student in a dynamic array to a sketch.
+ */
+void gpa_sketch_add_students(struct gpa_sketch* sketch,
+    struct dynarray* students);
+
+/*
+ * Merges the contents of one sketch into another.  Afterwards, into
+ * summarizes every GPA added to either sketch; from is left unchanged.  Both
+ * sketches should have been created with the same k.
+ *
+ * Params:
+ *   into - the sketch to merge into.  May not be NULL.
+ *   from - the sketch to merge from.  May not be NULL.
+ */
+void gpa_sketch_merge(struct gpa_sketch* into, struct gpa_sketch* from);
+
+/*
+ * Returns the number of GPAs summarized by a sketch.
+ */
+long long gpa_sketch_count(struct gpa_sketch* sketch);
+
+/*
+ * Returns an approximate quantile of the GPAs summarized by a sketch.
+ * Quantiles 0 and 1 return the exact lowest and highest GPAs.
+ *
+ * Params:
+ *   sketch - the sketch to query.  May not be NULL or empty.
+ *   q - the quantile, between 0 and 1 (e.g. 0.5 for the median).
+ */
+float gpa_sketch_quantile(struct gpa_sketch* sketch, double q);
+
+/*
+ * Works like create_student_array(), but also adds each student's GPA to a
+ * sketch as the student is created.
+ *
+ * Params:
+ *   num_students, names, ids, gpas - as for create_student_array().
+ *   sketch - the sketch to which the GPAs are added.  May not be NULL.
+ */
+struct dynarray* create_student_array_with_sketch(int num_students,
+    char** names, int* ids, float* gpas, struct gpa_sketch* sketch);
+
+#endif
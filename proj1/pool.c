@@ -0,0 +1,310 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a pool allocator of fixed-size objects.
+ *
+ * Free objects are kept in intrusive singly-linked lists: the first word of a
+ * free object points to the next one.  Each thread has a cache holding such a
+ * list, reached through a thread-specific key.  A thread only takes the
+ * pool's lock when its cache runs empty, to grab a batch of objects from the
+ * shared free list (or from a fresh slab), or when it grows too long, to hand
+ * a batch back.  If the key can't be created, every thread takes objects
+ * straight from the shared free list under the lock.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "pool.h"
+
+/*
+ * The size in bytes of the slabs objects are carved from.
+ */
+#define POOL_SLAB_SIZE 65536
+
+/*
+ * The number of objects moved between a thread's cache and the shared free
+ * list at a time.  A cache holding twice this many objects gives a batch
+ * back.
+ */
+#define POOL_BATCH 64
+
+/*
+ * This is a free object.
+ */
+struct pool_obj {
+  struct pool_obj* next;
+};
+
+/*
+ * This is a thread's cache of free objects.  All of a pool's caches are
+ * linked together so that pool_free() can release them.
+ */
+struct pool_cache {
+  struct pool* pool;
+  struct pool_obj* head;
+  int count;
+  struct pool_cache* prev;
+  struct pool_cache* next;
+};
+
+/*
+ * This is the definition of the pool structure.  has_key is nonzero if key
+ * could be created.  Everything below lock is protected by it.  bump and
+ * bump_end delimit the part of the newest slab that hasn't been handed out
+ * yet.
+ */
+struct pool {
+  size_t obj_size;
+  int objs_per_slab;
+  int has_key;
+  pthread_key_t key;
+  pthread_mutex_t lock;
+  struct pool_obj* free_list;
+  char** slabs;
+  int num_slabs;
+  int slabs_cap;
+  char* bump;
+  char* bump_end;
+  struct pool_cache* caches;
+};
+
+
+/*
+ * Auxilliary function to unlink a cache from its pool.  The pool's lock must
+ * be held.
+ */
+static void _pool_unlink_cache(struct pool_cache* cache) {
+  if (cache->prev) {
+    cache->prev->next = cache->next;
+  } else {
+    cache->pool->caches = cache->next;
+  }
+  if (cache->next) {
+    cache->next->prev = cache->prev;
+  }
+}
+
+
+/*
+ * Auxilliary function called when a thread exits.  Its cached objects go
+ * back to the shared free list.
+ */
+static void _pool_cache_destroy(void* arg) {
+  struct pool_cache* cache = arg;
+  struct pool* pool = cache->pool;
+
+  pthread_mutex_lock(&pool->lock);
+  while (cache->head) {
+    struct pool_obj* obj = cache->head;
+    cache->head = obj->next;
+    obj->next = pool->free_list;
+    pool->free_list = obj;
+  }
+  _pool_unlink_cache(cache);
+  pthread_mutex_unlock(&pool->lock);
+  free(cache);
+}
+
+
+/*
+ * Auxilliary function returning the calling thread's cache, creating it on
+ * first use, or NULL if the thread can't have a cache.
+ */
+static struct pool_cache* _pool_get_cache(struct pool* pool) {
+  if (!pool->has_key) {
+    return NULL;
+  }
+  struct pool_cache* cache = pthread_getspecific(pool->key);
+  if (cache) {
+    return cache;
+  }
+
+  cache = malloc(sizeof(struct pool_cache));
+  assert(cache);
+  cache->pool = pool;
+  cache->head = NULL;
+  cache->count = 0;
+  cache->prev = NULL;
+
+  pthread_mutex_lock(&pool->lock);
+  cache->next = pool->caches;
+  if (pool->caches) {
+    pool->caches->prev = cache;
+  }
+  pool->caches = cache;
+  pthread_mutex_unlock(&pool->lock);
+
+  if (pthread_setspecific(pool->key, cache) != 0) {
+    pthread_mutex_lock(&pool->lock);
+    _pool_unlink_cache(cache);
+    pthread_mutex_unlock(&pool->lock);
+    free(cache);
+    return NULL;
+  }
+  return cache;
+}
+
+
+/*
+ * Auxilliary function to carve one object out of the newest slab, starting
+ * a new slab if it is used up.  The pool's lock must be held.
+ */
+static struct pool_obj* _pool_carve(struct pool* pool) {
+  if (pool->bump == pool->bump_end) {
+    if (pool->num_slabs == pool->slabs_cap) {
+      pool->slabs_cap = pool->slabs_cap ? 2 * pool->slabs_cap : 4;
+      pool->slabs = realloc(pool->slabs, pool->slabs_cap * sizeof(char*));
+      assert(pool->slabs);
+    }
+    char* slab = malloc(pool->objs_per_slab * pool->obj_size);
+    assert(slab);
+    pool->slabs[pool->num_slabs++] = slab;
+    pool->bump = slab;
+    pool->bump_end = slab + pool->objs_per_slab * pool->obj_size;
+  }
+
+  struct pool_obj* obj = (struct pool_obj*)pool->bump;
+  pool->bump += pool->obj_size;
+  return obj;
+}
+
+
+/*
+ * Auxilliary function to refill an empty cache with a batch of objects,
+ * taken from the shared free list first and then from the newest slab.  The
+ * pool's lock must be held.
+ */
+static void _pool_refill(struct pool* pool, struct pool_cache* cache) {
+  while (cache->count < POOL_BATCH && pool->free_list) {
+    struct pool_obj* obj = pool->free_list;
+    pool->free_list = obj->next;
+    obj->next = cache->head;
+    cache->head = obj;
+    cache->count++;
+  }
+
+  while (cache->count < POOL_BATCH) {
+    struct pool_obj* obj = _pool_carve(pool);
+    obj->next = cache->head;
+    cache->head = obj;
+    cache->count++;
+  }
+}
+
+
+struct pool* pool_create(size_t obj_size) {
+  assert(obj_size > 0);
+  struct pool* pool = malloc(sizeof(struct pool));
+  assert(pool);
+
+  /*
+   * Every object must be able to hold a free list link, and rounding up to a
+   * multiple of the pointer size keeps consecutive objects aligned.
+   */
+  size_t align = sizeof(struct pool_obj);
+  pool->obj_size = (obj_size + align - 1) / align * align;
+  pool->objs_per_slab = POOL_SLAB_SIZE / pool->obj_size;
+  if (pool->objs_per_slab < 1) {
+    pool->objs_per_slab = 1;
+  }
+
+  pool->has_key = pthread_key_create(&pool->key, _pool_cache_destroy) == 0;
+  pthread_mutex_init(&pool->lock, NULL);
+  pool->free_list = NULL;
+  pool->slabs = NULL;
+  pool->num_slabs = 0;
+  pool->slabs_cap = 0;
+  pool->bump = pool->bump_end = NULL;
+  pool->caches = NULL;
+  return pool;
+}
+
+
+void pool_free(struct pool* pool) {
+  assert(pool);
+
+  /*
+   * Deleting the key first keeps exiting threads from running the cache
+   * destructor on a pool that no longer exists.
+   */
+  if (pool->has_key) {
+    pthread_key_delete(pool->key);
+  }
+  while (pool->caches) {
+    struct pool_cache* cache = pool->caches;
+    pool->caches = cache->next;
+    free(cache);
+  }
+  for (int i = 0; i < pool->num_slabs; i++) {
+    free(pool->slabs[i]);
+  }
+  free(pool->slabs);
+  pthread_mutex_destroy(&pool->lock);
+  free(pool);
+}
+
+
+void* pool_alloc(struct pool* pool) {
+  assert(pool);
+  struct pool_cache* cache = _pool_get_cache(pool);
+  if (!cache) {
+    pthread_mutex_lock(&pool->lock);
+    struct pool_obj* obj = pool->free_list;
+    if (obj) {
+      pool->free_list = obj->next;
+    } else {
+      obj = _pool_carve(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return obj;
+  }
+
+  if (!cache->head) {
+    pthread_mutex_lock(&pool->lock);
+    _pool_refill(pool, cache);
+    pthread_mutex_unlock(&pool->lock);
+  }
+
+  struct pool_obj* obj = cache->head;
+  cache->head = obj->next;
+  cache->count--;
+  return obj;
+}
+
+
+void pool_release(struct pool* pool, void* obj) {
+  assert(pool && obj);
+  struct pool_cache* cache = _pool_get_cache(pool);
+  struct pool_obj* released = obj;
+  if (!cache) {
+    pthread_mutex_lock(&pool->lock);
+    released->next = pool->free_list;
+    pool->free_list = released;
+    pthread_mutex_unlock(&pool->lock);
+    return;
+  }
+
+  released->next = cache->head;
+  cache->head = released;
+  cache->count++;
+
+  if (cache->count >= 2 * POOL_BATCH) {
+    /*
+     * Hand a batch back so that objects released by one thread can be
+     * reused by others.
+     */
+    struct pool_obj* first = cache->head;
+    struct pool_obj* last = first;
+    for (int i = 1; i < POOL_BATCH; i++) {
+      last = last->next;
+    }
+    cache->head = last->next;
+    cache->count -= POOL_BATCH;
+
+    pthread_mutex_lock(&pool->lock);
+    last->next = pool->free_list;
+    pool->free_list = first;
+    pthread_mutex_unlock(&pool->lock);
+  }
+}
@@ -0,0 +1,59 @@
+/*
+ * This file contains the definition of an interface for a pool allocator of
+ * fixed-size objects.  Objects are carved out of large slabs, and each thread
+ * keeps its own list of free objects, so most allocations and releases are a
+ * single pointer push or pop without any locking.
+ */
+
+#ifndef __POOL_H
+#define __POOL_H
+
+#include <stddef.h>
+
+/*
+ * Structure used to represent a pool.
+ */
+struct pool;
+
+/*
+ * Creates a new pool handing out objects of a given size and returns a
+ * pointer to it.  Objects are aligned to at least the size of a pointer.
+ *
+ * Params:
+ *   obj_size - the size in bytes of each object.  Must be greater than 0.
+ */
+struct pool* pool_create(size_t obj_size);
+
+/*
+ * Free the memory associated with a pool, including every object allocated
+ * from it, whether or not it has been released.  No other thread may be
+ * using the pool when it is freed.
+ *
+ * Params:
+ *   pool - the pool to be destroyed.  May not be NULL.
+ */
+void pool_free(struct pool* pool);
+
+/*
+ * Allocates an object from a pool.  The contents of the object are
+ * undefined.
+ *
+ * Params:
+ *   pool - the pool to allocate from.  May not be NULL.
+ *
+ * Return:
+ *   Returns a pointer to the object.
+ */
+void* pool_alloc(struct pool* pool);
+
+/*
+ * Returns an object to a pool.  Any thread may release an object, no matter
+ * which thread allocated it.
+ *
+ * Params:
+ *   pool - the pool the object was allocated from.  May not be NULL.
+ *   obj - the object to release.  May not be NULL.
+ */
+void pool_release(struct pool* pool, void* obj);
+
+#endif
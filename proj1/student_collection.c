@@ -0,0 +1,355 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a student collection that maintains GPA aggregates incrementally.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_collection.h"
+
+/*
+ * The number of rounded-GPA buckets counted by the Fenwick tree.
+ */
+#define GPA_BUCKETS \
+  (STUDENT_COLLECTION_MAX_GPA * STUDENT_COLLECTION_GPA_SCALE + 1)
+
+/*
+ * This is the definition of the student collection structure.  argmax and
+ * argmin are the indices of the first students with the highest and lowest
+ * GPAs.  When one of them may no longer be accurate (because that student was
+ * removed or moved away from the extreme), it is set to -1 and recomputed on
+ * the next query.  gpa_tree is a Fenwick tree (binary indexed tree) counting
+ * students per rounded-GPA bucket; it is 1-indexed, so entry 0 is unused.
+ */
+struct student_collection {
+  struct dynarray* students;
+  int argmax;
+  int argmin;
+  double gpa_sum;
+  int gpa_tree[GPA_BUCKETS + 1];
+};
+
+
+/*
+ * Auxilliary function mapping a GPA to its bucket, clamped to the range of
+ * the tree.
+ */
+static int _gpa_bucket(float gpa) {
+  double scaled = floor((double)gpa * STUDENT_COLLECTION_GPA_SCALE + 0.5);
+  if (!(scaled >= 0)) {
+    return 0;
+  }
+  if (scaled > GPA_BUCKETS - 1) {
+    return GPA_BUCKETS - 1;
+  }
+  return (int)scaled;
+}
+
+
+/*
+ * Auxilliary function to add delta to the count of a bucket.
+ */
+static void _gpa_tree_add(struct student_collection* collection, float gpa,
+    int delta) {
+  for (int i = _gpa_bucket(gpa) + 1; i <= GPA_BUCKETS; i += i & -i) {
+    collection->gpa_tree[i] += delta;
+  }
+}
+
+
+/*
+ * Auxilliary function returning the number of students in buckets
+ * 0 through bucket - 1.
+ */
+static int _gpa_tree_prefix(struct student_collection* collection,
+    int bucket) {
+  int count = 0;
+  for (int i = bucket; i > 0; i -= i & -i) {
+    count += collection->gpa_tree[i];
+  }
+  return count;
+}
+
+
+/*
+ * Auxilliary function to recompute whichever extremes are stale in a single
+ * pass over the collection.
+ */
+static void _student_collection_rebuild(struct student_collection* collection) {
+  int n = dynarray_size(collection->students);
+  int fix_max = collection->argmax < 0;
+  int fix_min = collection->argmin < 0;
+  if (n == 0) {
+    return;
+  }
+
+  struct student* first = dynarray_get(collection->students, 0);
+  float max = first->gpa, min = first->gpa;
+  int argmax = 0, argmin = 0;
+  for (int i = 1; i < n; i++) {
+    struct student* student = dynarray_get(collection->students, i);
+    if (student->gpa > max) {
+      max = student->gpa;
+      argmax = i;
+    }
+    if (student->gpa < min) {
+      min = student->gpa;
+      argmin = i;
+    }
+  }
+
+  if (fix_max) {
+    collection->argmax = argmax;
+  }
+  if (fix_min) {
+    collection->argmin = argmin;
+  }
+}
+
+
+/*
+ * Auxilliary function returning nonzero if the student at idx should replace
+ * the student at cur as an extreme.  sign is 1 for the maximum and -1 for the
+ * minimum.  Earlier students win ties.
+ */
+static int _student_collection_beats(struct student_collection* collection,
+    int idx, int cur, int sign) {
+  float gpa = ((struct student*)dynarray_get(collection->students, idx))->gpa;
+  float cur_gpa =
+    ((struct student*)dynarray_get(collection->students, cur))->gpa;
+  if (gpa != cur_gpa) {
+    return sign > 0 ? gpa > cur_gpa : gpa < cur_gpa;
+  }
+  return idx < cur;
+}
+
+
+struct student_collection* student_collection_create() {
+  struct student_collection* collection =
+    malloc(sizeof(struct student_collection));
+  assert(collection);
+  collection->students = dynarray_create();
+  collection->argmax = -1;
+  collection->argmin = -1;
+  collection->gpa_sum = 0.0;
+  for (int i = 0; i <= GPA_BUCKETS; i++) {
+    collection->gpa_tree[i] = 0;
+  }
+  return collection;
+}
+
+
+void student_collection_free(struct student_collection* collection) {
+  assert(collection);
+  int n = dynarray_size(collection->students);
+  for (int i = 0; i < n; i++) {
+    free_student(dynarray_get(collection->students, i));
+  }
+  dynarray_free(collection->students);
+  free(collection);
+}
+
+
+int student_collection_size(struct student_collection* collection) {
+  assert(collection);
+  return dynarray_size(collection->students);
+}
+
+
+struct student* student_collection_get(struct student_collection* collection,
+    int idx) {
+  assert(collection);
+  return dynarray_get(collection->students, idx);
+}
+
+
+struct dynarray* student_collection_array(
+    struct student_collection* collection) {
+  assert(collection);
+  return collection->students;
+}
+
+
+void student_collection_add(struct student_collection* collection,
+    struct student* student) {
+  assert(collection && student);
+
+  int was_empty = dynarray_size(collection->students) == 0;
+  dynarray_insert(collection->students, -1, student);
+  collection->gpa_sum += student->gpa;
+  _gpa_tree_add(collection, student->gpa, 1);
+
+  int idx = dynarray_size(collection->students) - 1;
+  if (was_empty) {
+    collection->argmax = collection->argmin = idx;
+    return;
+  }
+  if (collection->argmax >= 0 &&
+      _student_collection_beats(collection, idx, collection->argmax, 1)) {
+    collection->argmax = idx;
+  }
+  if (collection->argmin >= 0 &&
+      _student_collection_beats(collection, idx, collection->argmin, -1)) {
+    collection->argmin = idx;
+  }
+}
+
+
+struct student* student_collection_remove(
+    struct student_collection* collection, int idx) {
+  assert(collection);
+
+  struct student* student = dynarray_get(collection->students, idx);
+  dynarray_remove(collection->students, idx);
+  collection->gpa_sum -= student->gpa;
+  _gpa_tree_add(collection, student->gpa, -1);
+
+  /*
+   * Students behind the removed one move forward by one.  If the removed
+   * student was an extreme, it has to be found again.
+   */
+  if (collection->argmax == idx) {
+    collection->argmax = -1;
+  } else if (collection->argmax > idx) {
+    collection->argmax--;
+  }
+  if (collection->argmin == idx) {
+    collection->argmin = -1;
+  } else if (collection->argmin > idx) {
+    collection->argmin--;
+  }
+
+  if (dynarray_size(collection->students) == 0) {
+    collection->gpa_sum = 0.0;
+  }
+  return student;
+}
+
+
+void student_collection_set_gpa(struct student_collection* collection,
+    int idx, float gpa) {
+  assert(collection);
+
+  struct student* student = dynarray_get(collection->students, idx);
+  float old_gpa = student->gpa;
+  student->gpa = gpa;
+  collection->gpa_sum += (double)gpa - old_gpa;
+  if (_gpa_bucket(gpa) != _gpa_bucket(old_gpa)) {
+    _gpa_tree_add(collection, old_gpa, -1);
+    _gpa_tree_add(collection, gpa, 1);
+  }
+
+  if (collection->argmax == idx) {
+    if (gpa < old_gpa) {
+      collection->argmax = -1;
+    }
+  } else if (collection->argmax >= 0 &&
+      _student_collection_beats(collection, idx, collection->argmax, 1)) {
+    collection->argmax = idx;
+  }
+
+  if (collection->argmin == idx) {
+    if (gpa > old_gpa) {
+      collection->argmin = -1;
+    }
+  } else if (collection->argmin >= 0 &&
+      _student_collection_beats(collection, idx, collection->argmin, -1)) {
+    collection->argmin = idx;
+  }
+}
+
+
+struct student* student_collection_max_gpa(
+    struct student_collection* collection) {
+  assert(collection);
+  if (dynarray_size(collection->students) == 0) {
+    return NULL;
+  }
+  if (collection->argmax < 0) {
+    _student_collection_rebuild(collection);
+  }
+  return dynarray_get(collection->students, collection->argmax);
+}
+
+
+struct student* student_collection_min_gpa(
+    struct student_collection* collection) {
+  assert(collection);
+  if (dynarray_size(collection->students) == 0) {
+    return NULL;
+  }
+  if (collection->argmin < 0) {
+    _student_collection_rebuild(collection);
+  }
+  return dynarray_get(collection->students, collection->argmin);
+}
+
+
+double student_collection_gpa_sum(struct student_collection* collection) {
+  assert(collection);
+  return collection->gpa_sum;
+}
+
+
+double student_collection_mean_gpa(struct student_collection* collection) {
+  assert(collection);
+  int n = dynarray_size(collection->students);
+  return n ? collection->gpa_sum / n : 0.0;
+}
+
+
+int student_collection_count_in_gpa_range(
+    struct student_collection* collection, float lo, float hi) {
+  assert(collection);
+
+  /*
+   * A bucket b is in range when b / SCALE lies in [lo, hi].  The small slack
+   * keeps bounds like 2.9f, which is slightly below 2.9, from excluding
+   * their own bucket.
+   */
+  double lo_scaled = ceil((double)lo * STUDENT_COLLECTION_GPA_SCALE - 1e-3);
+  double hi_scaled = floor((double)hi * STUDENT_COLLECTION_GPA_SCALE + 1e-3);
+  if (lo_scaled > hi_scaled || hi_scaled < 0 || lo_scaled > GPA_BUCKETS - 1) {
+    return 0;
+  }
+  int first = lo_scaled < 0 ? 0 : (int)lo_scaled;
+  int last = hi_scaled > GPA_BUCKETS - 1 ? GPA_BUCKETS - 1 : (int)hi_scaled;
+  return _gpa_tree_prefix(collection, last + 1) -
+    _gpa_tree_prefix(collection, first);
+}
+
+
+float student_collection_gpa_percentile(struct student_collection* collection,
+    double p) {
+  assert(collection);
+  int n = dynarray_size(collection->students);
+  assert(n > 0 && p >= 0.0 && p <= 100.0);
+
+  int rank = (int)ceil(p / 100.0 * n);
+  if (rank < 1) {
+    rank = 1;
+  }
+
+  /*
+   * Walk down the implicit tree, descending right whenever the whole left
+   * subtree holds fewer than rank students, to find the first bucket whose
+   * prefix count reaches rank.
+   */
+  int pos = 0;
+  int step = 1;
+  while (step * 2 <= GPA_BUCKETS) {
+    step *= 2;
+  }
+  for (; step > 0; step /= 2) {
+    if (pos + step <= GPA_BUCKETS && collection->gpa_tree[pos + step] < rank) {
+      pos += step;
+      rank -= collection->gpa_tree[pos];
+    }
+  }
+
+  return (float)pos / STUDENT_COLLECTION_GPA_SCALE;
+}
@@ -0,0 +1,146 @@
+/*
+ * This file contains the definition of an interface for a student collection:
+ * a dynamic array of students that keeps aggregate GPA information up to date
+ * as students are added, removed and changed, so that queries like the
+ * highest or lowest GPA don't have to scan the whole array.
+ */
+
+#ifndef __STUDENT_COLLECTION_H
+#define __STUDENT_COLLECTION_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * GPA range and percentile queries work on GPAs rounded to the nearest
+ * 1 / STUDENT_COLLECTION_GPA_SCALE (i.e. hundredths).  GPAs below 0 or above
+ * STUDENT_COLLECTION_MAX_GPA are counted as if they were at those bounds.
+ */
+#define STUDENT_COLLECTION_GPA_SCALE 100
+#define STUDENT_COLLECTION_MAX_GPA 5
+
+/*
+ * Structure used to represent a student collection.
+ */
+struct student_collection;
+
+/*
+ * Creates a new, empty student collection and returns a pointer to it.
+ */
+struct student_collection* student_collection_create();
+
+/*
+ * Free the memory associated with a student collection, including every
+ * student still stored in it, which is freed with free_student().
+ *
+ * Params:
+ *   collection - the collection to be destroyed.  May not be NULL.
+ */
+void student_collection_free(struct student_collection* collection);
+
+/*
+ * Returns the number of students in a collection.
+ */
+int student_collection_size(struct student_collection* collection);
+
+/*
+ * Returns the idx'th student in a collection.  idx must be between 0 and the
+ * size of the collection.  The student's GPA must only be changed through
+ * student_collection_set_gpa().
+ */
+struct student* student_collection_get(struct student_collection* collection,
+    int idx);
+
+/*
+ * Returns the dynamic array underlying a collection, e.g. to pass it to
+ * print_students().  The array must not be modified directly.
+ */
+struct dynarray* student_collection_array(
+    struct student_collection* collection);
+
+/*
+ * Adds a student to the end of a collection.  The collection takes
+ * ownership of the student.
+ *
+ * Params:
+ *   collection - the collection to add to.  May not be NULL.
+ *   student - the student to be added.  May not be NULL.
+ */
+void student_collection_add(struct student_collection* collection,
+    struct student* student);
+
+/*
+ * Removes the idx'th student from a collection.  Ownership of the removed
+ * student passes back to the caller.
+ *
+ * Params:
+ *   collection - the collection to remove from.  May not be NULL.
+ *   idx - the index of the student to be removed.  Must be between 0 and the
+ *     size of the collection.
+ *
+ * Return:
+ *   Returns the removed student.
+ */
+struct student* student_collection_remove(
+    struct student_collection* collection, int idx);
+
+/*
+ * Changes the GPA of the idx'th student in a collection.
+ *
+ * Params:
+ *   collection - the collection holding the student.  May not be NULL.
+ *   idx - the index of the student to be changed.  Must be between 0 and the
+ *     size of the collection.
+ *   gpa - the student's new GPA.
+ */
+void student_collection_set_gpa(struct student_collection* collection,
+    int idx, float gpa);
+
+/*
+ * Return the student with the highest or lowest GPA in a collection, or NULL
+ * if the collection is empty.  Like find_max_gpa() and find_min_gpa(), the
+ * first such student is returned when several share the same GPA.  These run
+ * in O(1) time, except right after the current extreme has been removed or
+ * lowered (raised), when the next call rescans the collection once.
+ */
+struct student* student_collection_max_gpa(
+    struct student_collection* collection);
+struct student* student_collection_min_gpa(
+    struct student_collection* collection);
+
+/*
+ * Return the sum and the mean of the GPAs in a collection.  The mean of an
+ * empty collection is 0.
+ */
+double student_collection_gpa_sum(struct student_collection* collection);
+double student_collection_mean_gpa(struct student_collection* collection);
+
+/*
+ * Returns the number of students in a collection whose GPA, rounded to
+ * hundredths, is between lo and hi, inclusive.  This runs in O(log b) time,
+ * where b is the number of distinct rounded GPAs.
+ *
+ * Params:
+ *   collection - the collection to query.  May not be NULL.
+ *   lo, hi - the bounds of the GPA range.
+ */
+int student_collection_count_in_gpa_range(
+    struct student_collection* collection, float lo, float hi);
+
+/*
+ * Returns the GPA at a given percentile of a collection, using the
+ * nearest-rank definition: the smallest rounded GPA such that at least p
+ * percent of the students have a GPA at or below it.  Percentile 0 gives the
+ * lowest GPA and percentile 100 the highest.  This runs in O(log b) time.
+ *
+ * Params:
+ *   collection - the collection to query.  May not be NULL or empty.
+ *   p - the percentile, between 0 and 100.
+ *
+ * Return:
+ *   Returns the GPA at percentile p, rounded to hundredths.
+ */
+float student_collection_gpa_percentile(struct student_collection* collection,
+    double p);
+
+#endif
@@ -0,0 +1,389 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * an external merge sort of student record files by GPA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "student_extsort.h"
+
+/*
+ * The most runs merged at once.  If there are more runs than this, groups of
+ * runs are merged into longer runs first.
+ */
+#define EXTSORT_MAX_FANIN 64
+
+/*
+ * The smallest stdio buffer given to the output file of the final merge.
+ * Run files keep stdio's default buffers: setvbuf() may only be called
+ * before a file is first used, and a budget-sized buffer on every run
+ * written would make buffer memory grow with the number of runs.
+ */
+#define EXTSORT_MIN_BUFFER 4096
+
+/*
+ * This is the fixed-size part of a STUDENT_FORMAT_BINARY record.  The name
+ * bytes follow it.
+ */
+struct extsort_header {
+  int32_t id;
+  float gpa;
+  uint32_t name_len;
+};
+
+/*
+ * This is an entry in the index of the run being formed.  offset locates the
+ * record in the run arena, and seq is its position in the input, which
+ * breaks ties between equal GPAs.
+ */
+struct extsort_entry {
+  size_t offset;
+  float gpa;
+  size_t seq;
+};
+
+/*
+ * This is one input of a merge: a run file along with the record currently
+ * at its front.
+ */
+struct extsort_reader {
+  FILE* file;
+  int run;
+  struct extsort_header header;
+  char* name;
+  size_t name_cap;
+};
+
+
+/*
+ * Auxilliary function to read the next record header from a file.  Returns
+ * 1 if a header was read, 0 at a clean end of file, or -1 on error.
+ */
+static int _extsort_read_header(FILE* file, struct extsort_header* header) {
+  size_t n = fread(header, 1, sizeof(*header), file);
+  if (n == sizeof(*header)) {
+    return 1;
+  }
+  return n == 0 && !ferror(file) ? 0 : -1;
+}
+
+
+/*
+ * Auxilliary function to order index entries by descending GPA, then by
+ * input position.
+ */
+static int _extsort_compare_entries(const void* a, const void* b) {
+  const struct extsort_entry* x = a;
+  const struct extsort_entry* y = b;
+  if (x->gpa != y->gpa) {
+    return x->gpa > y->gpa ? -1 : 1;
+  }
+  return x->seq < y->seq ? -1 : x->seq > y->seq;
+}
+
+
+/*
+ * Auxilliary function to sort the run held in memory and write it to a file.
+ */
+static int _extsort_write_run(FILE* file, char* arena,
+    struct extsort_entry* entries, size_t count) {
+  qsort(entries, count, sizeof(struct extsort_entry), _extsort_compare_entries);
+  for (size_t i = 0; i < count; i++) {
+    struct extsort_header header;
+    memcpy(&header, arena + entries[i].offset, sizeof(header));
+    size_t len = sizeof(header) + header.name_len;
+    if (fwrite(arena + entries[i].offset, 1, len, file) != len) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+
+/*
+ * Auxilliary function to load the next record of a merge input.  Returns 1
+ * if a record was loaded, 0 if the input is exhausted, or -1 on error.
+ */
+static int _extsort_advance(struct extsort_reader* reader) {
+  int status = _extsort_read_header(reader->file, &reader->header);
+  if (status <= 0) {
+    return status;
+  }
+  if (reader->header.name_len > reader->name_cap) {
+    free(reader->name);
+    reader->name_cap = reader->header.name_len;
+    reader->name = malloc(reader->name_cap);
+    assert(reader->name);
+  }
+  size_t len = reader->header.name_len;
+  return fread(reader->name, 1, len, reader->file) == len ? 1 : -1;
+}
+
+
+/*
+ * Auxilliary function returning nonzero if reader a's record comes before
+ * reader b's.  Records from earlier runs win ties, which keeps the merge
+ * stable.
+ */
+static int _extsort_reader_first(struct extsort_reader* a,
+    struct extsort_reader* b) {
+  if (a->header.gpa != b->header.gpa) {
+    return a->header.gpa > b->header.gpa;
+  }
+  return a->run < b->run;
+}
+
+
+/*
+ * Auxilliary function to restore the heap property below heap[idx].
+ */
+static void _extsort_sift_down(struct extsort_reader** heap, int size,
+    int idx) {
+  struct extsort_reader* reader = heap[idx];
+  while (2 * idx + 1 < size) {
+    int child = 2 * idx + 1;
+    if (child + 1 < size &&
+        _extsort_reader_first(heap[child + 1], heap[child])) {
+      child++;
+    }
+    if (!_extsort_reader_first(heap[child], reader)) {
+      break;
+    }
+    heap[idx] = heap[child];
+    idx = child;
+  }
+  heap[idx] = reader;
+}
+
+
+/*
+ * Auxilliary function to merge count run files, in order, into out.
+ */
+static int _extsort_merge(FILE** runs, int count, FILE* out) {
+  if (count == 0) {
+    return 0;
+  }
+
+  struct extsort_reader* readers =
+    calloc(count, sizeof(struct extsort_reader));
+  struct extsort_reader** heap =
+    malloc(count * sizeof(struct extsort_reader*));
+  assert(readers && heap);
+
+  int size = 0;
+  int status = 0;
+  for (int i = 0; i < count && !status; i++) {
+    readers[i].file = runs[i];
+    readers[i].run = i;
+    rewind(runs[i]);
+    int loaded = _extsort_advance(&readers[i]);
+    if (loaded < 0) {
+      status = -1;
+    } else if (loaded) {
+      heap[size++] = &readers[i];
+    }
+  }
+  for (int i = size / 2 - 1; i >= 0; i--) {
+    _extsort_sift_down(heap, size, i);
+  }
+
+  while (size > 0 && !status) {
+    struct extsort_reader* first = heap[0];
+    if (fwrite(&first->header, sizeof(first->header), 1, out) != 1 ||
+        fwrite(first->name, 1, first->header.name_len, out) !=
+          first->header.name_len) {
+      status = -1;
+      break;
+    }
+
+    int loaded = _extsort_advance(first);
+    if (loaded < 0) {
+      status = -1;
+    } else if (!loaded) {
+      heap[0] = heap[--size];
+    }
+    if (size > 0) {
+      _extsort_sift_down(heap, size, 0);
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    free(readers[i].name);
+  }
+  free(heap);
+  free(readers);
+  return status;
+}
+
+
+/*
+ * Auxilliary function to merge groups of runs until at most
+ * EXTSORT_MAX_FANIN remain.  Each group is replaced by its merged run in the
+ * same position, so run order (and with it stability) is preserved.
+ */
+static int _extsort_reduce_runs(FILE** runs, int* count) {
+  while (*count > EXTSORT_MAX_FANIN) {
+    int merged = 0;
+    for (int first = 0; first < *count; first += EXTSORT_MAX_FANIN) {
+      int group = *count - first;
+      if (group > EXTSORT_MAX_FANIN) {
+        group = EXTSORT_MAX_FANIN;
+      }
+
+      FILE* out = tmpfile();
+      if (!out || _extsort_merge(runs + first, group, out) != 0) {
+        if (out) {
+          fclose(out);
+        }
+        return -1;
+      }
+      for (int i = 0; i < group; i++) {
+        fclose(runs[first + i]);
+        runs[first + i] = NULL;
+      }
+      runs[merged++] = out;
+    }
+
+    /*
+     * Any slots past the merged runs were closed above.
+     */
+    *count = merged;
+  }
+  return 0;
+}
+
+
+int external_sort_by_gpa(const char* in_path, const char* out_path,
+    size_t memory_budget) {
+  assert(in_path && out_path);
+  if (memory_budget < EXTSORT_MIN_MEMORY) {
+    memory_budget = EXTSORT_MIN_MEMORY;
+  }
+
+  FILE* in = fopen(in_path, "rb");
+  if (!in) {
+    return -1;
+  }
+
+  size_t arena_cap = memory_budget / 2;
+  size_t entries_cap = memory_budget / 2 / sizeof(struct extsort_entry);
+  char* arena = malloc(arena_cap);
+  struct extsort_entry* entries =
+    malloc(entries_cap * sizeof(struct extsort_entry));
+  assert(arena && entries);
+
+  int runs_cap = 16, num_runs = 0;
+  FILE** runs = malloc(runs_cap * sizeof(FILE*));
+  assert(runs);
+
+  /*
+   * Read runs until the input is exhausted.  Half of the budget holds the
+   * records themselves and half holds the index that gets sorted.
+   */
+  int status = 0, written = 0;
+  size_t arena_len = 0, count = 0, seq = 0;
+  for (;;) {
+    struct extsort_header header;
+    int more = _extsort_read_header(in, &header);
+    if (more < 0) {
+      status = -1;
+      break;
+    }
+
+    size_t len = more ? sizeof(header) + header.name_len : 0;
+    if (count > 0 &&
+        (!more || arena_len + len > arena_cap || count == entries_cap)) {
+      if (!more && num_runs == 0) {
+        /*
+         * Everything fit in a single run, so it goes straight to the output.
+         */
+        FILE* out = fopen(out_path, "wb");
+        status = out ? _extsort_write_run(out, arena, entries, count) : -1;
+        if (out && fclose(out) != 0) {
+          status = -1;
+        }
+        written = 1;
+        break;
+      }
+
+      /*
+       * The run is full (or the input is done), so spill it.
+       */
+      FILE* run = tmpfile();
+      if (!run || _extsort_write_run(run, arena, entries, count) != 0) {
+        if (run) {
+          fclose(run);
+        }
+        status = -1;
+        break;
+      }
+      if (num_runs == runs_cap) {
+        runs_cap *= 2;
+        runs = realloc(runs, runs_cap * sizeof(FILE*));
+        assert(runs);
+      }
+      runs[num_runs++] = run;
+      arena_len = 0;
+      count = 0;
+    }
+    if (!more) {
+      break;
+    }
+
+    if (len > arena_cap) {
+      arena_cap = len;
+      arena = realloc(arena, arena_cap);
+      assert(arena);
+    }
+    memcpy(arena + arena_len, &header, sizeof(header));
+    if (fread(arena + arena_len + sizeof(header), 1, header.name_len, in) !=
+        header.name_len) {
+      status = -1;
+      break;
+    }
+    entries[count].offset = arena_len;
+    entries[count].gpa = header.gpa;
+    entries[count].seq = seq++;
+    count++;
+    arena_len += len;
+  }
+  fclose(in);
+  free(entries);
+  free(arena);
+
+  if (!status && !written) {
+    size_t buffer_size = memory_budget / (EXTSORT_MAX_FANIN + 1);
+    if (buffer_size < EXTSORT_MIN_BUFFER) {
+      buffer_size = EXTSORT_MIN_BUFFER;
+    }
+
+    /*
+     * An empty input leaves no runs and produces an empty output.
+     */
+    status = _extsort_reduce_runs(runs, &num_runs);
+    if (!status) {
+      FILE* out = fopen(out_path, "wb");
+      if (!out) {
+        status = -1;
+      } else {
+        setvbuf(out, NULL, _IOFBF, buffer_size);
+        status = _extsort_merge(runs, num_runs, out);
+        if (fclose(out) != 0) {
+          status = -1;
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < num_runs; i++) {
+    if (runs[i]) {
+      fclose(runs[i]);
+    }
+  }
+  free(runs);
+  return status;
+}
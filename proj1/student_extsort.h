@@ -0,0 +1,40 @@
+/*
+ * This file contains the definition of an interface for sorting student
+ * records that are stored in a file and may not fit in memory.
+ */
+
+#ifndef __STUDENT_EXTSORT_H
+#define __STUDENT_EXTSORT_H
+
+#include <stddef.h>
+
+/*
+ * The smallest memory budget external_sort_by_gpa() will work with.  Smaller
+ * budgets are rounded up to this.
+ */
+#define EXTSORT_MIN_MEMORY (64 * 1024)
+
+/*
+ * Sorts a file of student records by descending GPA using an external merge
+ * sort.  Both files hold records in the STUDENT_FORMAT_BINARY layout written
+ * by write_students().  Records are read in runs that fit in the memory
+ * budget, each run is sorted and spilled to a temporary file, and the runs
+ * are then merged with a heap.  The sort is stable: students with equal GPAs
+ * keep their order from the input file.
+ *
+ * Params:
+ *   in_path - the file of records to be sorted.  May not be NULL.
+ *   out_path - the file the sorted records are written to.  May not be NULL
+ *     and may not be the same file as in_path.
+ *   memory_budget - the approximate number of bytes of memory the sort may
+ *     use for records and buffers.  A single record larger than the budget
+ *     is still handled, using as much memory as that record needs.
+ *
+ * Return:
+ *   Returns 0 on success or -1 if a file could not be read or written or
+ *   the input ends in the middle of a record.
+ */
+int external_sort_by_gpa(const char* in_path, const char* out_path,
+    size_t memory_budget);
+
+#endif
@@ -0,0 +1,279 @@
+/*
+ * This file contains the definitions of functions for writing arrays of
+ * students to a file descriptor through a large output buffer, using
+ * hand-written integer and float formatters in place of printf().
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_format.h"
+
+/*
+ * The size of the output buffer.  A block is handed to write() whenever the
+ * next row might not fit.
+ */
+#define FORMAT_BUFFER_SIZE (1 << 20)
+
+/*
+ * The most bytes a row can take apart from the name: the longest fixed text,
+ * an 11-character integer, and a float of up to FORMAT_MAX_FAST_FLOAT with six
+ * decimals (or its snprintf() fallback, which is capped below).
+ */
+#define FORMAT_MAX_ROW_OVERHEAD 128
+
+/*
+ * Floats at or above this magnitude are handed to snprintf(), so the fast
+ * path always fits in a 64-bit integer of millionths.
+ */
+#define FORMAT_MAX_FAST_FLOAT 1e12
+
+/*
+ * This is the output buffer along with the file descriptor it drains to.
+ */
+struct format_buffer {
+  char* data;
+  size_t len;
+  int fd;
+  int failed;
+};
+
+
+/*
+ * Auxilliary function to write all len bytes of data to fd, retrying after
+ * short writes and interrupted calls.
+ */
+static int _format_write_all(int fd, const char* data, size_t len) {
+  while (len > 0) {
+    ssize_t written = write(fd, data, len);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    data += written;
+    len -= (size_t)written;
+  }
+  return 0;
+}
+
+
+/*
+ * Auxilliary function to hand the buffered bytes to the kernel.
+ */
+static void _format_flush(struct format_buffer* buf) {
+  if (!buf->failed && buf->len > 0 &&
+      _format_write_all(buf->fd, buf->data, buf->len) != 0) {
+    buf->failed = 1;
+  }
+  buf->len = 0;
+}
+
+
+/*
+ * Auxilliary function to make sure at least n more bytes fit in the buffer.
+ * Returns 0 if they do, or -1 if n is larger than the whole buffer.
+ */
+static int _format_reserve(struct format_buffer* buf, size_t n) {
+  if (buf->len + n > FORMAT_BUFFER_SIZE) {
+    _format_flush(buf);
+  }
+  return n <= FORMAT_BUFFER_SIZE ? 0 : -1;
+}
+
+
+/*
+ * Auxilliary function to append bytes to the buffer.  Anything too large to
+ * be buffered is written straight through.
+ */
+static void _format_bytes(struct format_buffer* buf, const void* data,
+    size_t n) {
+  if (_format_reserve(buf, n) != 0) {
+    if (!buf->failed && _format_write_all(buf->fd, data, n) != 0) {
+      buf->failed = 1;
+    }
+    return;
+  }
+  memcpy(buf->data + buf->len, data, n);
+  buf->len += n;
+}
+
+
+/*
+ * Auxilliary function to format an unsigned integer into out, returning the
+ * number of characters written.  Digits are produced right to left into a
+ * scratch array and then copied out in one go.
+ */
+static int _format_uint(char* out, uint64_t value) {
+  char digits[20];
+  int n = 0;
+  do {
+    digits[sizeof(digits) - 1 - n++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value);
+  memcpy(out, digits + sizeof(digits) - n, n);
+  return n;
+}
+
+
+/*
+ * Auxilliary function to format a signed integer into out.
+ */
+static int _format_int(char* out, int value) {
+  if (value < 0) {
+    *out = '-';
+    return 1 + _format_uint(out + 1, -(int64_t)value);
+  }
+  return _format_uint(out, (uint64_t)value);
+}
+
+
+/*
+ * Auxilliary function to format a float into out with six decimal places,
+ * producing the same text as printf("%f").  Values outside the fast path's
+ * range, as well as NaNs and infinities, are formatted with snprintf().
+ */
+static int _format_float(char* out, float value) {
+  double v = value;
+  if (!(fabs(v) < FORMAT_MAX_FAST_FLOAT)) {
+    return snprintf(out, FORMAT_MAX_ROW_OVERHEAD / 2, "%f", v);
+  }
+
+  int n = 0;
+  if (signbit(v)) {
+    out[n++] = '-';
+    v = -v;
+  }
+
+  /*
+   * Work in millionths.  Like printf(), round exact halves to even.
+   */
+  double scaled = v * 1e6;
+  uint64_t millionths = (uint64_t)scaled;
+  double rest = scaled - (double)millionths;
+  if (rest > 0.5 || (rest == 0.5 && (millionths & 1))) {
+    millionths++;
+  }
+
+  n += _format_uint(out + n, millionths / 1000000);
+  out[n++] = '.';
+
+  uint32_t frac = (uint32_t)(millionths % 1000000);
+  for (int i = 5; i >= 0; i--) {
+    out[n + i] = (char)('0' + frac % 10);
+    frac /= 10;
+  }
+  return n + 6;
+}
+
+
+/*
+ * Auxilliary function to append one student as a text or TSV row.
+ */
+static void _format_text_row(struct format_buffer* buf,
+    struct student* student, enum student_format format) {
+  static const char text_name[] = "  - name: ";
+  static const char text_id[] = "\tid: ";
+  static const char text_gpa[] = "\tgpa: ";
+
+  size_t name_len = strlen(student->name);
+  if (_format_reserve(buf, name_len + FORMAT_MAX_ROW_OVERHEAD) != 0) {
+    /*
+     * The name alone doesn't fit in the buffer, so write it through and
+     * format the rest of the row on its own.
+     */
+    if (format == STUDENT_FORMAT_TEXT) {
+      _format_bytes(buf, text_name, sizeof(text_name) - 1);
+    }
+    _format_bytes(buf, student->name, name_len);
+    name_len = 0;
+    _format_reserve(buf, FORMAT_MAX_ROW_OVERHEAD);
+  } else {
+    if (format == STUDENT_FORMAT_TEXT) {
+      memcpy(buf->data + buf->len, text_name, sizeof(text_name) - 1);
+      buf->len += sizeof(text_name) - 1;
+    }
+    memcpy(buf->data + buf->len, student->name, name_len);
+    buf->len += name_len;
+  }
+
+  char* out = buf->data + buf->len;
+  if (format == STUDENT_FORMAT_TEXT) {
+    memcpy(out, text_id, sizeof(text_id) - 1);
+    out += sizeof(text_id) - 1;
+  } else {
+    *out++ = '\t';
+  }
+  out += _format_int(out, student->id);
+  if (format == STUDENT_FORMAT_TEXT) {
+    memcpy(out, text_gpa, sizeof(text_gpa) - 1);
+    out += sizeof(text_gpa) - 1;
+  } else {
+    *out++ = '\t';
+  }
+  out += _format_float(out, student->gpa);
+  *out++ = '\n';
+  buf->len = out - buf->data;
+}
+
+
+/*
+ * Auxilliary function to append one student as a binary record.
+ */
+static void _format_binary_row(struct format_buffer* buf,
+    struct student* student) {
+  int32_t id = student->id;
+  float gpa = student->gpa;
+  uint32_t name_len = (uint32_t)strlen(student->name);
+
+  _format_reserve(buf, sizeof(id) + sizeof(gpa) + sizeof(name_len));
+  memcpy(buf->data + buf->len, &id, sizeof(id));
+  buf->len += sizeof(id);
+  memcpy(buf->data + buf->len, &gpa, sizeof(gpa));
+  buf->len += sizeof(gpa);
+  memcpy(buf->data + buf->len, &name_len, sizeof(name_len));
+  buf->len += sizeof(name_len);
+  _format_bytes(buf, student->name, name_len);
+}
+
+
+int write_students(struct dynarray* students, int fd,
+    enum student_format format) {
+  assert(students);
+
+  struct format_buffer buf;
+  buf.data = malloc(FORMAT_BUFFER_SIZE);
+  assert(buf.data);
+  buf.len = 0;
+  buf.fd = fd;
+  buf.failed = 0;
+
+  if (format == STUDENT_FORMAT_TSV) {
+    _format_bytes(&buf, "name\tid\tgpa\n", 12);
+  }
+
+  int n = dynarray_size(students);
+  for (int i = 0; i < n && !buf.failed; i++) {
+    struct student* student = dynarray_get(students, i);
+    if (format == STUDENT_FORMAT_BINARY) {
+      _format_binary_row(&buf, student);
+    } else {
+      _format_text_row(&buf, student, format);
+    }
+  }
+  _format_flush(&buf);
+
+  free(buf.data);
+  return buf.failed ? -1 : 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * This file contains the definition of an interface for writing arrays of
+ * students to a file descriptor in bulk.  Rows are formatted into a large
+ * buffer that is handed to the kernel one block at a time, instead of making
+ * one stdio call per student.
+ */
+
+#ifndef __STUDENT_FORMAT_H
+#define __STUDENT_FORMAT_H
+
+#include "dynarray.h"
+
+/*
+ * The output formats supported by write_students().
+ *
+ *   STUDENT_FORMAT_TEXT - the same lines print_students() prints, i.e.
+ *     "  - name: <name>\tid: <id>\tgpa: <gpa>" with the GPA printed with six
+ *     decimal places.
+ *   STUDENT_FORMAT_TSV - a "name\tid\tgpa" header line followed by one
+ *     tab-separated line per student, with the GPA printed as above.
+ *   STUDENT_FORMAT_BINARY - one record per student: the ID as a 32-bit
+ *     integer, the GPA as a 32-bit float, the length of the name as a 32-bit
+ *     unsigned integer, and then the bytes of the name without a terminating
+ *     NUL.  Values are written in the host's byte order.
+ */
+enum student_format {
+  STUDENT_FORMAT_TEXT,
+  STUDENT_FORMAT_TSV,
+  STUDENT_FORMAT_BINARY
+};
+
+/*
+ * Writes every student in a dynamic array to a file descriptor in the given
+ * format.
+ *
+ * Params:
+ *   students - the dynamic array of students to be written.  May not be
+ *     NULL.
+ *   fd - the file descriptor to write to.  Nothing is buffered in stdio, so
+ *     if fd is also used through a FILE*, that stream should be flushed
+ *     first.
+ *   format - the output format.
+ *
+ * Return:
+ *   Returns 0 on success or -1 if writing to fd failed.
+ */
+int write_students(struct dynarray* students, int fd,
+    enum student_format format);
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a hash index from student IDs to students.  The index uses open addressing
+ * with robin hood probing: every slot remembers how far it sits from its home
+ * slot, and an insertion that has probed further than the current occupant
+ * takes that slot over.  This keeps probe sequences short and lets lookups of
+ * missing IDs stop early.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_index.h"
+#include "student_ingest.h"
+
+#define STUDENT_INDEX_MIN_BITS 4
+
+/*
+ * This is the definition of a single slot in the index.  dist is one more
+ * than the slot's distance from the home slot of its ID, so an empty slot has
+ * dist 0.  The ID is stored in the slot to avoid touching the student struct
+ * while probing.
+ */
+struct slot {
+  struct student* student;
+  int id;
+  int dist;
+};
+
+/*
+ * This is the definition of the index structure.  The number of slots is
+ * always a power of two, 1 << bits.
+ */
+struct student_index {
+  struct slot* slots;
+  int bits;
+  int mask;
+  int size;
+};
+
+
+/*
+ * Auxilliary function to compute the home slot of an ID using Fibonacci
+ * hashing.
+ */
+static int _student_index_home(struct student_index* index, int id) {
+  uint64_t h = (uint64_t)(uint32_t)id * UINT64_C(0x9E3779B97F4A7C15);
+  return (int)(h >> (64 - index->bits));
+}
+
+
+/*
+ * Auxilliary function to allocate an empty slot array of 1 << bits slots.
+ */
+static void _student_index_init(struct student_index* index, int bits) {
+  index->bits = bits;
+  index->mask = (1 << bits) - 1;
+  index->size = 0;
+  index->slots = calloc((size_t)1 << bits, sizeof(struct slot));
+  assert(index->slots);
+}
+
+
+/*
+ * Auxilliary function to compute the number of slot bits needed to hold a
+ * given number of students below the maximum load factor of 7/8.
+ */
+static int _student_index_bits_for(int capacity) {
+  int bits = STUDENT_INDEX_MIN_BITS;
+  while (((int64_t)1 << bits) * 7 / 8 < capacity) {
+    bits++;
+  }
+  return bits;
+}
+
+
+/*
+ * Auxilliary function to place a student into the index without checking
+ * the load factor.
+ */
+static int _student_index_place(struct student_index* index,
+    struct student* student) {
+  struct slot carried = { student, student->id, 1 };
+  int i = _student_index_home(index, carried.id);
+
+  while (index->slots[i].dist) {
+    struct slot* slot = &index->slots[i];
+
+    /*
+     * Until the first swap, the carried student is the one being inserted, so
+     * this is where a duplicate ID would show up.  Robin hood ordering
+     * guarantees it is found before any slot closer to home than we are.
+     */
+    if (carried.student == student && slot->id == carried.id) {
+      return 0;
+    }
+
+    if (slot->dist < carried.dist) {
+      struct slot tmp = *slot;
+      *slot = carried;
+      carried = tmp;
+    }
+
+    i = (i + 1) & index->mask;
+    carried.dist++;
+  }
+
+  index->slots[i] = carried;
+  index->size++;
+  return 1;
+}
+
+
+/*
+ * Auxilliary function to rehash the index into twice as many slots.
+ */
+static void _student_index_grow(struct student_index* index) {
+  struct slot* old_slots = index->slots;
+  int old_capacity = 1 << index->bits;
+
+  _student_index_init(index, index->bits + 1);
+  for (int i = 0; i < old_capacity; i++) {
+    if (old_slots[i].dist) {
+      _student_index_place(index, old_slots[i].student);
+    }
+  }
+  free(old_slots);
+}
+
+
+/*
+ * Auxilliary function to find the slot holding a given ID, or -1.
+ */
+static int _student_index_find(struct student_index* index, int id) {
+  int i = _student_index_home(index, id);
+  for (int dist = 1; index->slots[i].dist >= dist; dist++) {
+    if (index->slots[i].id == id) {
+      return i;
+    }
+    i = (i + 1) & index->mask;
+  }
+  return -1;
+}
+
+
+struct student_index* student_index_create(int capacity) {
+  assert(capacity >= 0);
+  struct student_index* index = malloc(sizeof(struct student_index));
+  assert(index);
+  _student_index_init(index, _student_index_bits_for(capacity));
+  return index;
+}
+
+
+void student_index_free(struct student_index* index) {
+  assert(index);
+  free(index->slots);
+  free(index);
+}
+
+
+int student_index_size(struct student_index* index) {
+  assert(index);
+  return index->size;
+}
+
+
+int student_index_insert(struct student_index* index, struct student* student) {
+  assert(index && student);
+  if ((int64_t)(index->size + 1) * 8 > ((int64_t)1 << index->bits) * 7) {
+    _student_index_grow(index);
+  }
+  return _student_index_place(index, student);
+}
+
+
+struct student* student_index_lookup(struct student_index* index, int id) {
+  assert(index);
+  int i = _student_index_find(index, id);
+  return i < 0 ? NULL : index->slots[i].student;
+}
+
+
+struct student* student_index_remove(struct student_index* index, int id) {
+  assert(index);
+  int i = _student_index_find(index, id);
+  if (i < 0) {
+    return NULL;
+  }
+
+  struct student* removed = index->slots[i].student;
+
+  /*
+   * Shift the following slots back by one until we reach an empty slot or
+   * one that is already in its home slot, so no tombstones are needed.
+   */
+  int next = (i + 1) & index->mask;
+  while (index->slots[next].dist > 1) {
+    index->slots[i] = index->slots[next];
+    index->slots[i].dist--;
+    i = next;
+    next = (next + 1) & index->mask;
+  }
+  index->slots[i].dist = 0;
+  index->slots[i].student = NULL;
+  index->size--;
+
+  return removed;
+}
+
+
+struct student_index* student_index_build(struct dynarray* students) {
+  assert(students);
+  int n = dynarray_size(students);
+  struct student_index* index = student_index_create(n);
+  for (int i = 0; i < n; i++) {
+    _student_index_place(index, dynarray_get(students, i));
+  }
+  return index;
+}
+
+
+/*
+ * Auxilliary function placing a student in the index passed as arg unless
+ * its ID is already there.  It is used as the ingest hook of
+ * create_indexed_student_array().
+ */
+static int _student_index_ingest(struct student* student, void* arg) {
+  struct student_index* index = arg;
+  if (_student_index_find(index, student->id) >= 0) {
+    return 0;
+  }
+  _student_index_place(index, student);
+  return 1;
+}
+
+
+struct dynarray* create_indexed_student_array(int num_students, char** names,
+    int* ids, float* gpas, struct student_index** index) {
+  struct student_index* built = student_index_create(num_students);
+  struct dynarray* students = create_student_array_with_hook(num_students,
+    names, ids, gpas, _student_index_ingest, built);
+
+  if (index) {
+    *index = built;
+  } else {
+    student_index_free(built);
+  }
+  return students;
+}
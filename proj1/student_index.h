@@ -0,0 +1,111 @@
+/*
+ * This file contains the definition of an interface for a hash index that
+ * maps student IDs to the student structs stored in a dynamic array.  The
+ * index does not own the students it refers to; freeing the index leaves the
+ * students untouched.
+ */
+
+#ifndef __STUDENT_INDEX_H
+#define __STUDENT_INDEX_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * Structure used to represent a student index.
+ */
+struct student_index;
+
+/*
+ * Creates a new, empty student index and returns a pointer to it.
+ *
+ * Params:
+ *   capacity - the number of students the index should be able to hold
+ *     before it has to grow.  May be 0.
+ */
+struct student_index* student_index_create(int capacity);
+
+/*
+ * Free the memory associated with a student index.  The students referred
+ * to by the index are not freed.
+ *
+ * Params:
+ *   index - the index to be destroyed.  May not be NULL.
+ */
+void student_index_free(struct student_index* index);
+
+/*
+ * Returns the number of students stored in an index.
+ */
+int student_index_size(struct student_index* index);
+
+/*
+ * Inserts a student into an index, keyed by its ID.  If a student with the
+ * same ID is already in the index, the index is left unchanged.
+ *
+ * Params:
+ *   index - the index into which to insert the student.  May not be NULL.
+ *   student - the student to be inserted.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if the student was inserted or 0 if its ID was a duplicate.
+ */
+int student_index_insert(struct student_index* index, struct student* student);
+
+/*
+ * Looks up a student by ID.
+ *
+ * Params:
+ *   index - the index in which to look up the ID.  May not be NULL.
+ *   id - the ID of the student to be found.
+ *
+ * Return:
+ *   Returns the student with the given ID, or NULL if there is none.
+ */
+struct student* student_index_lookup(struct student_index* index, int id);
+
+/*
+ * Removes the student with a given ID from an index.
+ *
+ * Params:
+ *   index - the index from which to remove the student.  May not be NULL.
+ *   id - the ID of the student to be removed.
+ *
+ * Return:
+ *   Returns the removed student, or NULL if there was no student with the
+ *   given ID.
+ */
+struct student* student_index_remove(struct student_index* index, int id);
+
+/*
+ * Builds an index over all of the students in a dynamic array.  The index is
+ * sized once up front.  If several students share an ID, the first one in the
+ * array is the one that is indexed.
+ *
+ * Params:
+ *   students - the dynamic array of students to be indexed.  May not be NULL.
+ *
+ * Return:
+ *   Returns a newly-allocated index over the students in the array.
+ */
+struct student_index* student_index_build(struct dynarray* students);
+
+/*
+ * Works like create_student_array(), but also builds an index by ID while
+ * the array is being filled.  Only the first student with any given ID is
+ * stored; later records with the same ID are freed as soon as they are
+ * created.
+ *
+ * Params:
+ *   num_students, names, ids, gpas - as for create_student_array().
+ *   index - if not NULL, receives the index built over the returned array.
+ *     The caller is responsible for freeing it with student_index_free().
+ *
+ * Return:
+ *   Returns a newly-allocated dynamic array of students with unique IDs, in
+ *   the order they first appear in the input.
+ */
+struct dynarray* create_indexed_student_array(int num_students, char** names,
+    int* ids, float* gpas, struct student_index** index);
+
+#endif
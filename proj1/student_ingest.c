@@ -0,0 +1,94 @@
+/*
+ * This file contains the definitions of functions building arrays of
+ * students, either while calling a hook on each student or with several
+ * threads.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_ingest.h"
+#include "workers.h"
+
+/*
+ * This is the work description handed to each worker, which creates the
+ * students in [begin, end).
+ */
+struct ingest_worker {
+  struct dynarray* students;
+  char** names;
+  int* ids;
+  float* gpas;
+  int begin;
+  int end;
+};
+
+
+/*
+ * Auxilliary function creating the students of one slice.
+ */
+static void _ingest_worker_run(void* arg) {
+  struct ingest_worker* worker = arg;
+  for (int i = worker->begin; i < worker->end; i++) {
+    dynarray_set(worker->students, i,
+      create_student(worker->names[i], worker->ids[i], worker->gpas[i]));
+  }
+}
+
+
+struct dynarray* create_student_array_with_hook(int num_students,
+    char** names, int* ids, float* gpas, student_ingest_hook hook, void* arg) {
+  assert(num_students >= 0 && hook);
+  struct dynarray* students = dynarray_create();
+  dynarray_reserve(students, num_students);
+  for (int i = 0; i < num_students; i++) {
+    struct student* student = create_student(names[i], ids[i], gpas[i]);
+    if (hook(student, arg)) {
+      dynarray_insert(students, -1, student);
+    } else {
+      free_student(student);
+    }
+  }
+  return students;
+}
+
+
+struct dynarray* create_student_array_parallel(int num_students, char** names,
+    int* ids, float* gpas, int num_threads) {
+  assert(num_students >= 0);
+
+  if (num_threads <= 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = online > 0 ? (int)online : 1;
+  }
+  int max_threads = num_students / INGEST_MIN_SLICE;
+  if (num_threads > max_threads) {
+    num_threads = max_threads > 0 ? max_threads : 1;
+  }
+
+  struct dynarray* students = dynarray_create();
+  dynarray_resize(students, num_students);
+
+  struct ingest_worker* workers =
+    malloc(num_threads * sizeof(struct ingest_worker));
+  assert(workers);
+  for (int t = 0; t < num_threads; t++) {
+    workers[t].students = students;
+    workers[t].names = names;
+    workers[t].ids = ids;
+    workers[t].gpas = gpas;
+    workers[t].begin = (int)((long long)num_students * t / num_threads);
+    workers[t].end = (int)((long long)num_students * (t + 1) / num_threads);
+  }
+
+  run_workers(workers, sizeof(struct ingest_worker), num_threads,
+    _ingest_worker_run);
+
+  free(workers);
+  return students;
+}
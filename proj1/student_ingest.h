@@ -0,0 +1,55 @@
+/*
+ * This file contains the definition of an interface for building arrays of
+ * students with several threads.
+ */
+
+#ifndef __STUDENT_INGEST_H
+#define __STUDENT_INGEST_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * Arrays with fewer students than this are built by the calling thread
+ * alone, since starting threads would cost more than it saves.
+ */
+#define INGEST_MIN_SLICE 65536
+
+/*
+ * The type of the function called by create_student_array_with_hook() for
+ * each student it creates.  arg is the pointer passed to
+ * create_student_array_with_hook().  A nonzero return keeps the student in
+ * the array; zero drops it, and the student is freed.
+ */
+typedef int (*student_ingest_hook)(struct student* student, void* arg);
+
+/*
+ * Works like create_student_array(), but calls a hook on each student as it
+ * is created, so that other structures can be built in the same pass.  Kept
+ * students are stored in input order.
+ *
+ * Params:
+ *   num_students, names, ids, gpas - as for create_student_array().
+ *   hook - the function called for each student.  May not be NULL.
+ *   arg - passed through to hook.
+ */
+struct dynarray* create_student_array_with_hook(int num_students,
+    char** names, int* ids, float* gpas, student_ingest_hook hook, void* arg);
+
+/*
+ * Works like create_student_array(), but splits the work among several
+ * threads.  The array is sized for every student up front, and each thread
+ * then creates the students of its own contiguous slice and stores them in
+ * place, so no locking is needed.  The array is returned only once every
+ * thread has finished, and its contents are the same as those of
+ * create_student_array().
+ *
+ * Params:
+ *   num_students, names, ids, gpas - as for create_student_array().
+ *   num_threads - the number of threads to use.  If this is 0 or negative,
+ *     one thread per online processor is used.
+ */
+struct dynarray* create_student_array_parallel(int num_students, char** names,
+    int* ids, float* gpas, int num_threads);
+
+#endif
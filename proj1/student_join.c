@@ -0,0 +1,236 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * hash joins of student arrays on ID.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_join.h"
+
+/*
+ * The number of students per partition the partitioned join aims for.
+ */
+#define JOIN_TARGET_PARTITION_SIZE 4096
+
+/*
+ * This is a student along with the hash of its ID.  Both join variants work
+ * on arrays of these so that the hash is computed only once per student.
+ */
+struct join_tuple {
+  uint64_t hash;
+  int id;
+  struct student* student;
+};
+
+/*
+ * This is a chained hash table over an array of tuples.  heads[b] is the
+ * index of the first tuple in bucket b, and next[i] the index of the tuple
+ * after tuple i, with -1 ending a chain.
+ */
+struct join_table {
+  int* heads;
+  int* next;
+  int bits;
+  int shift;
+};
+
+
+/*
+ * Auxilliary function to hash an ID.  The high bits of the result are the
+ * best mixed, so partitions and buckets are taken from the top down.
+ */
+static uint64_t _join_hash(int id) {
+  return (uint64_t)(uint32_t)id * UINT64_C(0x9E3779B97F4A7C15);
+}
+
+
+/*
+ * Auxilliary function to fill an array of tuples from a dynamic array.
+ */
+static struct join_tuple* _join_tuples(struct dynarray* students) {
+  int n = dynarray_size(students);
+  struct join_tuple* tuples = malloc((n + 1) * sizeof(struct join_tuple));
+  assert(tuples);
+  for (int i = 0; i < n; i++) {
+    struct student* student = dynarray_get(students, i);
+    tuples[i].hash = _join_hash(student->id);
+    tuples[i].id = student->id;
+    tuples[i].student = student;
+  }
+  return tuples;
+}
+
+
+/*
+ * Auxilliary function to build a hash table over n tuples.  skip_bits high
+ * bits of the hash are ignored because they are the same for every tuple
+ * (they were used to pick the partition).  Tuples are chained in reverse so
+ * each chain lists its tuples in their original order.
+ */
+static void _join_build(struct join_table* table, struct join_tuple* tuples,
+    int n, int skip_bits) {
+  table->bits = 1;
+  while ((1 << table->bits) < 2 * n) {
+    table->bits++;
+  }
+  table->shift = 64 - skip_bits - table->bits;
+  table->heads = malloc((1 << table->bits) * sizeof(int));
+  table->next = malloc((n + 1) * sizeof(int));
+  assert(table->heads && table->next);
+
+  int mask = (1 << table->bits) - 1;
+  for (int b = 0; b <= mask; b++) {
+    table->heads[b] = -1;
+  }
+  for (int i = n - 1; i >= 0; i--) {
+    int b = (int)(tuples[i].hash >> table->shift) & mask;
+    table->next[i] = table->heads[b];
+    table->heads[b] = i;
+  }
+}
+
+
+/*
+ * Auxilliary function to probe a hash table with n tuples and report every
+ * match.  swapped is nonzero when the table was built over the first input,
+ * so that the callback still receives its arguments in input order.
+ */
+static long long _join_probe(struct join_table* table,
+    struct join_tuple* build, struct join_tuple* probe, int n, int swapped,
+    student_join_callback callback, void* arg) {
+  int mask = (1 << table->bits) - 1;
+  long long matches = 0;
+  for (int i = 0; i < n; i++) {
+    int b = (int)(probe[i].hash >> table->shift) & mask;
+    for (int j = table->heads[b]; j >= 0; j = table->next[j]) {
+      if (build[j].id == probe[i].id) {
+        if (swapped) {
+          callback(build[j].student, probe[i].student, arg);
+        } else {
+          callback(probe[i].student, build[j].student, arg);
+        }
+        matches++;
+      }
+    }
+  }
+  return matches;
+}
+
+
+/*
+ * Auxilliary function to scatter tuples into 2^bits partitions by the top
+ * bits of their hashes.  On return, partition p occupies
+ * out[offsets[p], offsets[p + 1]).
+ */
+static void _join_partition(struct join_tuple* tuples, int n, int bits,
+    struct join_tuple* out, int* offsets) {
+  int num_partitions = 1 << bits;
+  for (int p = 0; p <= num_partitions; p++) {
+    offsets[p] = 0;
+  }
+  for (int i = 0; i < n; i++) {
+    offsets[(bits ? tuples[i].hash >> (64 - bits) : 0) + 1]++;
+  }
+  for (int p = 0; p < num_partitions; p++) {
+    offsets[p + 1] += offsets[p];
+  }
+
+  int* cursor = malloc(num_partitions * sizeof(int));
+  assert(cursor);
+  for (int p = 0; p < num_partitions; p++) {
+    cursor[p] = offsets[p];
+  }
+  for (int i = 0; i < n; i++) {
+    int p = bits ? (int)(tuples[i].hash >> (64 - bits)) : 0;
+    out[cursor[p]++] = tuples[i];
+  }
+  free(cursor);
+}
+
+
+long long join_students_by_id(struct dynarray* a, struct dynarray* b,
+    student_join_callback callback, void* arg) {
+  assert(a && b && callback);
+
+  int na = dynarray_size(a), nb = dynarray_size(b);
+  int smaller = na < nb ? na : nb;
+  if (smaller >= JOIN_PARTITION_THRESHOLD) {
+    int bits = 0;
+    while ((smaller >> bits) > JOIN_TARGET_PARTITION_SIZE && bits < 16) {
+      bits++;
+    }
+    return join_students_by_id_partitioned(a, b, callback, arg, bits);
+  }
+
+  int swapped = na < nb;
+  struct dynarray* build_side = swapped ? a : b;
+  struct dynarray* probe_side = swapped ? b : a;
+
+  struct join_tuple* build = _join_tuples(build_side);
+  struct join_tuple* probe = _join_tuples(probe_side);
+  struct join_table table;
+  _join_build(&table, build, dynarray_size(build_side), 0);
+  long long matches = _join_probe(&table, build, probe,
+    dynarray_size(probe_side), swapped, callback, arg);
+
+  free(table.next);
+  free(table.heads);
+  free(probe);
+  free(build);
+  return matches;
+}
+
+
+long long join_students_by_id_partitioned(struct dynarray* a,
+    struct dynarray* b, student_join_callback callback, void* arg,
+    int partition_bits) {
+  assert(a && b && callback);
+  assert(partition_bits >= 0 && partition_bits <= 16);
+
+  int na = dynarray_size(a), nb = dynarray_size(b);
+  int swapped = na < nb;
+  struct dynarray* build_side = swapped ? a : b;
+  struct dynarray* probe_side = swapped ? b : a;
+  int n_build = dynarray_size(build_side);
+  int n_probe = dynarray_size(probe_side);
+
+  int num_partitions = 1 << partition_bits;
+  struct join_tuple* build_in = _join_tuples(build_side);
+  struct join_tuple* probe_in = _join_tuples(probe_side);
+  struct join_tuple* build = malloc((n_build + 1) * sizeof(struct join_tuple));
+  struct join_tuple* probe = malloc((n_probe + 1) * sizeof(struct join_tuple));
+  int* build_offsets = malloc((num_partitions + 1) * sizeof(int));
+  int* probe_offsets = malloc((num_partitions + 1) * sizeof(int));
+  assert(build && probe && build_offsets && probe_offsets);
+
+  _join_partition(build_in, n_build, partition_bits, build, build_offsets);
+  _join_partition(probe_in, n_probe, partition_bits, probe, probe_offsets);
+  free(probe_in);
+  free(build_in);
+
+  long long matches = 0;
+  for (int p = 0; p < num_partitions; p++) {
+    int build_n = build_offsets[p + 1] - build_offsets[p];
+    int probe_n = probe_offsets[p + 1] - probe_offsets[p];
+    if (build_n == 0 || probe_n == 0) {
+      continue;
+    }
+
+    struct join_table table;
+    _join_build(&table, build + build_offsets[p], build_n, partition_bits);
+    matches += _join_probe(&table, build + build_offsets[p],
+      probe + probe_offsets[p], probe_n, swapped, callback, arg);
+    free(table.next);
+    free(table.heads);
+  }
+
+  free(probe_offsets);
+  free(build_offsets);
+  free(probe);
+  free(build);
+  return matches;
+}
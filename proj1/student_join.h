@@ -0,0 +1,60 @@
+/*
+ * This file contains the definition of an interface for joining two arrays
+ * of students on their IDs.
+ */
+
+#ifndef __STUDENT_JOIN_H
+#define __STUDENT_JOIN_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * When the smaller input holds at least this many students,
+ * join_students_by_id() switches to the radix-partitioned join.
+ */
+#define JOIN_PARTITION_THRESHOLD 65536
+
+/*
+ * The type of the function called for every matching pair.  a and b are the
+ * matching students from the first and second input, respectively, and arg
+ * is the pointer passed to the join.
+ */
+typedef void (*student_join_callback)(struct student* a, struct student* b,
+    void* arg);
+
+/*
+ * Joins two arrays of students on ID with a hash join: a hash table is built
+ * over the smaller array and probed with each student of the larger one.
+ * callback is called once for every pair of students (one from each array)
+ * that share an ID, so duplicate IDs produce every combination.  Large inputs
+ * are joined with join_students_by_id_partitioned(); the order in which pairs
+ * are reported is otherwise unspecified.
+ *
+ * Params:
+ *   a, b - the arrays of students to join.  May not be NULL.
+ *   callback - the function called for each matching pair.  May not be NULL.
+ *   arg - passed through to callback.
+ *
+ * Return:
+ *   Returns the number of matching pairs.
+ */
+long long join_students_by_id(struct dynarray* a, struct dynarray* b,
+    student_join_callback callback, void* arg);
+
+/*
+ * Works like join_students_by_id(), but first scatters both inputs into
+ * 2^partition_bits partitions by hash, and then joins each pair of
+ * partitions on its own.  Each partition's hash table is small enough to
+ * stay in cache, which pays off when the smaller input's table would not.
+ *
+ * Params:
+ *   a, b, callback, arg - as for join_students_by_id().
+ *   partition_bits - the base-2 logarithm of the number of partitions,
+ *     between 0 and 16.
+ */
+long long join_students_by_id_partitioned(struct dynarray* a,
+    struct dynarray* b, student_join_callback callback, void* arg,
+    int partition_bits);
+
+#endif
@@ -0,0 +1,177 @@
+/*
+ * This file contains the definitions of functions that evaluate student
+ * queries.  Selection vectors are built without branching on the predicate
+ * outcome: every candidate index is written, and the output position only
+ * advances when the row matches.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_snapshot.h"
+#include "student_query.h"
+
+
+void student_query_init(struct student_query* query) {
+  assert(query);
+  query->has_gpa_range = 0;
+  query->gpa_lo = query->gpa_hi = 0.0f;
+  query->has_id_range = 0;
+  query->id_lo = query->id_hi = 0;
+  query->name_prefix = NULL;
+}
+
+
+void student_query_gpa_between(struct student_query* query, float lo,
+    float hi) {
+  assert(query);
+  query->has_gpa_range = 1;
+  query->gpa_lo = lo;
+  query->gpa_hi = hi;
+}
+
+
+void student_query_id_between(struct student_query* query, int lo, int hi) {
+  assert(query);
+  query->has_id_range = 1;
+  query->id_lo = lo;
+  query->id_hi = hi;
+}
+
+
+void student_query_name_prefix(struct student_query* query,
+    const char* prefix) {
+  assert(query);
+  query->name_prefix = prefix;
+}
+
+
+/*
+ * Auxilliary function evaluating the numeric predicates of a query on one
+ * row.  Returns 1 if the row passes them and 0 otherwise.
+ */
+static int _query_numeric_match(struct student_query* query, int id,
+    float gpa) {
+  int match = 1;
+  if (query->has_id_range) {
+    match &= (id >= query->id_lo) & (id <= query->id_hi);
+  }
+  if (query->has_gpa_range) {
+    match &= (gpa >= query->gpa_lo) & (gpa <= query->gpa_hi);
+  }
+  return match;
+}
+
+
+/*
+ * Auxilliary function to keep only the selected rows whose names start with
+ * the query's prefix.  name_at returns the name of a row.
+ */
+static int _query_refine_names(struct student_query* query, int* selection,
+    int count, const char* (*name_at)(void*, int), void* source) {
+  size_t len = strlen(query->name_prefix);
+  int kept = 0;
+  for (int i = 0; i < count; i++) {
+    selection[kept] = selection[i];
+    kept +=
+      strncmp(name_at(source, selection[i]), query->name_prefix, len) == 0;
+  }
+  return kept;
+}
+
+
+/*
+ * Accessors used to refine a selection over either kind of input.
+ */
+static const char* _query_array_name(void* source, int idx) {
+  return ((struct student*)dynarray_get(source, idx))->name;
+}
+
+static const char* _query_snapshot_name(void* source, int idx) {
+  return student_snapshot_name(source, idx);
+}
+
+
+int student_query_select(struct student_query* query,
+    struct dynarray* students, int* selection) {
+  assert(query && students && selection);
+
+  int n = dynarray_size(students);
+  int count = 0;
+  for (int i = 0; i < n; i++) {
+    struct student* student = dynarray_get(students, i);
+    selection[count] = i;
+    count += _query_numeric_match(query, student->id, student->gpa);
+  }
+
+  if (query->name_prefix) {
+    count = _query_refine_names(query, selection, count, _query_array_name,
+      students);
+  }
+  return count;
+}
+
+
+int student_query_select_snapshot(struct student_query* query,
+    struct student_snapshot* snapshot, int* selection) {
+  assert(query && snapshot && selection);
+
+  int n = student_snapshot_size(snapshot);
+  const int32_t* ids = student_snapshot_ids(snapshot);
+  const float* gpas = student_snapshot_gpas(snapshot);
+  int count = 0;
+  int i = 0;
+
+#ifdef __SSE2__
+  /*
+   * Evaluate four rows at a time.  Disabled predicates are given an all-ones
+   * mask so they don't filter anything.
+   */
+  const __m128i all = _mm_set1_epi32(-1);
+  const __m128i id_lo = _mm_set1_epi32(query->id_lo);
+  const __m128i id_hi = _mm_set1_epi32(query->id_hi);
+  const __m128 gpa_lo = _mm_set1_ps(query->gpa_lo);
+  const __m128 gpa_hi = _mm_set1_ps(query->gpa_hi);
+
+  for (; i + 4 <= n; i += 4) {
+    __m128i mask = all;
+    if (query->has_id_range) {
+      __m128i id = _mm_loadu_si128((const __m128i*)(ids + i));
+      __m128i out = _mm_or_si128(_mm_cmplt_epi32(id, id_lo),
+        _mm_cmpgt_epi32(id, id_hi));
+      mask = _mm_andnot_si128(out, mask);
+    }
+    if (query->has_gpa_range) {
+      __m128 gpa = _mm_loadu_ps(gpas + i);
+      __m128 in = _mm_and_ps(_mm_cmpge_ps(gpa, gpa_lo),
+        _mm_cmple_ps(gpa, gpa_hi));
+      mask = _mm_and_si128(mask, _mm_castps_si128(in));
+    }
+
+    int bits = _mm_movemask_ps(_mm_castsi128_ps(mask));
+    for (int j = 0; j < 4; j++) {
+      selection[count] = i + j;
+      count += (bits >> j) & 1;
+    }
+  }
+#endif
+
+  for (; i < n; i++) {
+    selection[count] = i;
+    count += _query_numeric_match(query, ids[i], gpas[i]);
+  }
+
+  if (query->name_prefix) {
+    count = _query_refine_names(query, selection, count, _query_snapshot_name,
+      snapshot);
+  }
+  return count;
+}
@@ -0,0 +1,80 @@
+/*
+ * This file contains the definition of an interface for filtering students by
+ * a conjunction of simple predicates.  A query is evaluated either over a
+ * dynamic array of students or, column at a time, over a mapped snapshot, and
+ * produces a selection vector: the ascending indices of the matching
+ * students.
+ */
+
+#ifndef __STUDENT_QUERY_H
+#define __STUDENT_QUERY_H
+
+#include "dynarray.h"
+#include "student_snapshot.h"
+
+/*
+ * Structure representing a query.  A student matches when it satisfies every
+ * predicate that is enabled.  Use student_query_init() and the functions
+ * below to set up a query rather than filling the fields in directly.
+ */
+struct student_query {
+  int has_gpa_range;
+  float gpa_lo;
+  float gpa_hi;
+  int has_id_range;
+  int id_lo;
+  int id_hi;
+  const char* name_prefix;
+};
+
+/*
+ * Initializes a query with no predicates, which matches every student.
+ */
+void student_query_init(struct student_query* query);
+
+/*
+ * Add a predicate to a query: GPA between lo and hi, ID between lo and hi
+ * (both inclusive), or name starting with prefix.  Setting the same kind of
+ * predicate twice replaces the earlier one.  The prefix string is not copied
+ * and must outlive the query.
+ */
+void student_query_gpa_between(struct student_query* query, float lo,
+    float hi);
+void student_query_id_between(struct student_query* query, int lo, int hi);
+void student_query_name_prefix(struct student_query* query,
+    const char* prefix);
+
+/*
+ * Evaluates a query over a dynamic array of students.
+ *
+ * Params:
+ *   query - the query to evaluate.  May not be NULL.
+ *   students - the students to filter.  May not be NULL.
+ *   selection - receives the indices of the matching students in ascending
+ *     order.  Must have room for dynarray_size(students) entries.
+ *
+ * Return:
+ *   Returns the number of matching students.
+ */
+int student_query_select(struct student_query* query,
+    struct dynarray* students, int* selection);
+
+/*
+ * Evaluates a query over the columns of a mapped snapshot.  The ID and GPA
+ * predicates are evaluated over whole columns, several rows per instruction
+ * where SSE2 is available, and the name predicate is then applied to the
+ * surviving rows only.
+ *
+ * Params:
+ *   query - the query to evaluate.  May not be NULL.
+ *   snapshot - the snapshot to filter.  May not be NULL.
+ *   selection - receives the indices of the matching rows in ascending
+ *     order.  Must have room for student_snapshot_size(snapshot) entries.
+ *
+ * Return:
+ *   Returns the number of matching rows.
+ */
+int student_query_select_snapshot(struct student_query* query,
+    struct student_snapshot* snapshot, int* selection);
+
+#endif
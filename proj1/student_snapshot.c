@@ -0,0 +1,327 @@
+/*
+ * This file contains the definitions of structures and functions for saving
+ * an array of students to a binary snapshot file and mapping it back into
+ * memory.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_snapshot.h"
+
+#define SNAPSHOT_MAGIC "STUDSNAP"
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+#define SNAPSHOT_ALIGN 8
+
+/*
+ * This is the on-disk header of a snapshot file.  All offsets are measured
+ * in bytes from the start of the file.
+ */
+struct snapshot_header {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t count;
+  uint64_t ids_offset;
+  uint64_t gpas_offset;
+  uint64_t name_offsets_offset;
+  uint64_t names_offset;
+  uint64_t names_size;
+};
+
+/*
+ * This is the definition of a mapped snapshot.  The column pointers all
+ * point into the mapping described by base and length.
+ */
+struct student_snapshot {
+  void* base;
+  size_t length;
+  int count;
+  const int32_t* ids;
+  const float* gpas;
+  const uint64_t* name_offsets;
+  const char* names;
+};
+
+
+/*
+ * Auxilliary function to round a file offset up to the snapshot alignment.
+ */
+static uint64_t _snapshot_align(uint64_t offset) {
+  return (offset + SNAPSHOT_ALIGN - 1) & ~(uint64_t)(SNAPSHOT_ALIGN - 1);
+}
+
+
+/*
+ * Auxilliary function to write zero bytes until the file position reaches
+ * the given offset.
+ */
+static int _snapshot_pad(FILE* file, uint64_t* pos, uint64_t offset) {
+  static const char zeros[SNAPSHOT_ALIGN] = { 0 };
+  size_t n = (size_t)(offset - *pos);
+  if (n && fwrite(zeros, 1, n, file) != n) {
+    return -1;
+  }
+  *pos = offset;
+  return 0;
+}
+
+
+int save_student_array(struct dynarray* students, const char* path) {
+  assert(students && path);
+
+  int n = dynarray_size(students);
+  int32_t* ids = malloc(n * sizeof(int32_t) + 1);
+  float* gpas = malloc(n * sizeof(float) + 1);
+  uint64_t* name_offsets = malloc((n + 1) * sizeof(uint64_t));
+  assert(ids && gpas && name_offsets);
+
+  /*
+   * Gather the columns in a single pass over the array.  Each name takes its
+   * length plus a terminating NUL in the blob.
+   */
+  uint64_t names_size = 0;
+  for (int i = 0; i < n; i++) {
+    struct student* student = dynarray_get(students, i);
+    ids[i] = student->id;
+    gpas[i] = student->gpa;
+    name_offsets[i] = names_size;
+    names_size += strlen(student->name) + 1;
+  }
+  name_offsets[n] = names_size;
+
+  struct snapshot_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = STUDENT_SNAPSHOT_VERSION;
+  header.byte_order = SNAPSHOT_BYTE_ORDER;
+  header.count = n;
+  header.ids_offset = _snapshot_align(sizeof(header));
+  header.gpas_offset = _snapshot_align(header.ids_offset + n * sizeof(int32_t));
+  header.name_offsets_offset =
+    _snapshot_align(header.gpas_offset + n * sizeof(float));
+  header.names_offset = _snapshot_align(header.name_offsets_offset +
+    (n + 1) * sizeof(uint64_t));
+  header.names_size = names_size;
+
+  /*
+   * Write everything to a temporary file next to the destination and only
+   * rename it into place once it has been completely written.
+   */
+  size_t path_len = strlen(path);
+  char* tmp_path = malloc(path_len + 5);
+  assert(tmp_path);
+  memcpy(tmp_path, path, path_len);
+  memcpy(tmp_path + path_len, ".tmp", 5);
+
+  int status = -1;
+  uint64_t pos = 0;
+  FILE* file = fopen(tmp_path, "wb");
+  if (file) {
+    status = 0;
+    if (fwrite(&header, sizeof(header), 1, file) != 1) status = -1;
+    pos = sizeof(header);
+
+    if (!status) status = _snapshot_pad(file, &pos, header.ids_offset);
+    if (!status && fwrite(ids, sizeof(int32_t), n, file) != (size_t)n) {
+      status = -1;
+    }
+    pos += n * sizeof(int32_t);
+
+    if (!status) status = _snapshot_pad(file, &pos, header.gpas_offset);
+    if (!status && fwrite(gpas, sizeof(float), n, file) != (size_t)n) {
+      status = -1;
+    }
+    pos += n * sizeof(float);
+
+    if (!status) status = _snapshot_pad(file, &pos, header.name_offsets_offset);
+    if (!status && fwrite(name_offsets, sizeof(uint64_t), n + 1, file) !=
+        (size_t)(n + 1)) {
+      status = -1;
+    }
+    pos += (n + 1) * sizeof(uint64_t);
+
+    if (!status) status = _snapshot_pad(file, &pos, header.names_offset);
+    for (int i = 0; i < n && !status; i++) {
+      struct student* student = dynarray_get(students, i);
+      size_t len = (size_t)(name_offsets[i + 1] - name_offsets[i]);
+      if (fwrite(student->name, 1, len, file) != len) {
+        status = -1;
+      }
+    }
+
+    /*
+     * Make sure the data is on disk before the rename makes it visible, so a
+     * crash can't leave a truncated snapshot under the final name.
+     */
+    if (!status && (fflush(file) != 0 || fsync(fileno(file)) != 0)) {
+      status = -1;
+    }
+    if (fclose(file) != 0) {
+      status = -1;
+    }
+    if (!status && rename(tmp_path, path) != 0) {
+      status = -1;
+    }
+    if (status) {
+      remove(tmp_path);
+    }
+  }
+
+  free(tmp_path);
+  free(name_offsets);
+  free(gpas);
+  free(ids);
+  return status;
+}
+
+
+struct student_snapshot* map_student_array(const char* path) {
+  assert(path);
+
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct snapshot_header)) {
+    close(fd);
+    return NULL;
+  }
+
+  size_t length = (size_t)st.st_size;
+  void* base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    return NULL;
+  }
+
+  /*
+   * Validate the header and make sure every section lies inside the file.
+   * Each check is written as offset <= length && size <= length - offset so
+   * that a corrupt offset can't wrap around.  n is at most INT32_MAX, so the
+   * section sizes themselves can't overflow.
+   */
+  const struct snapshot_header* header = base;
+  uint64_t n = header->count;
+  int valid = memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) == 0
+    && header->version == STUDENT_SNAPSHOT_VERSION
+    && header->byte_order == SNAPSHOT_BYTE_ORDER
+    && n <= (uint64_t)INT32_MAX
+    && header->ids_offset % SNAPSHOT_ALIGN == 0
+    && header->gpas_offset % SNAPSHOT_ALIGN == 0
+    && header->name_offsets_offset % SNAPSHOT_ALIGN == 0
+    && header->ids_offset <= length
+    && n * sizeof(int32_t) <= length - header->ids_offset
+    && header->gpas_offset <= length
+    && n * sizeof(float) <= length - header->gpas_offset
+    && header->name_offsets_offset <= length
+    && (n + 1) * sizeof(uint64_t) <= length - header->name_offsets_offset
+    && header->names_offset <= length
+    && header->names_size <= length - header->names_offset;
+
+  const uint64_t* name_offsets = NULL;
+  const char* names = NULL;
+  if (valid) {
+    name_offsets =
+      (const uint64_t*)((const char*)base + header->name_offsets_offset);
+    names = (const char*)base + header->names_offset;
+    valid = name_offsets[n] == header->names_size
+      && (n == 0 || names[header->names_size - 1] == '\0');
+
+    /*
+     * Every name takes at least its NUL, so the name offsets must strictly
+     * increase.  Together with the check above, this keeps every name
+     * inside the blob and terminated.
+     */
+    for (uint64_t i = 0; i < n && valid; i++) {
+      valid = name_offsets[i] < name_offsets[i + 1];
+    }
+  }
+
+  if (!valid) {
+    munmap(base, length);
+    return NULL;
+  }
+
+  struct student_snapshot* snapshot = malloc(sizeof(struct student_snapshot));
+  assert(snapshot);
+  snapshot->base = base;
+  snapshot->length = length;
+  snapshot->count = (int)n;
+  snapshot->ids = (const int32_t*)((const char*)base + header->ids_offset);
+  snapshot->gpas = (const float*)((const char*)base + header->gpas_offset);
+  snapshot->name_offsets = name_offsets;
+  snapshot->names = names;
+  return snapshot;
+}
+
+
+void unmap_student_array(struct student_snapshot* snapshot) {
+  assert(snapshot);
+  munmap(snapshot->base, snapshot->length);
+  free(snapshot);
+}
+
+
+int student_snapshot_size(struct student_snapshot* snapshot) {
+  assert(snapshot);
+  return snapshot->count;
+}
+
+
+int student_snapshot_id(struct student_snapshot* snapshot, int idx) {
+  assert(snapshot);
+  assert(idx >= 0 && idx < snapshot->count);
+  return snapshot->ids[idx];
+}
+
+
+float student_snapshot_gpa(struct student_snapshot* snapshot, int idx) {
+  assert(snapshot);
+  assert(idx >= 0 && idx < snapshot->count);
+  return snapshot->gpas[idx];
+}
+
+
+const char* student_snapshot_name(struct student_snapshot* snapshot, int idx) {
+  assert(snapshot);
+  assert(idx >= 0 && idx < snapshot->count);
+  return snapshot->names + snapshot->name_offsets[idx];
+}
+
+
+const int32_t* student_snapshot_ids(struct student_snapshot* snapshot) {
+  assert(snapshot);
+  return snapshot->ids;
+}
+
+
+const float* student_snapshot_gpas(struct student_snapshot* snapshot) {
+  assert(snapshot);
+  return snapshot->gpas;
+}
+
+
+struct dynarray* student_snapshot_to_array(struct student_snapshot* snapshot) {
+  assert(snapshot);
+
+  struct dynarray* students = dynarray_create();
+  for (int i = 0; i < snapshot->count; i++) {
+    char* name = (char*)(snapshot->names + snapshot->name_offsets[i]);
+    dynarray_insert(students, -1,
+      create_student(name, snapshot->ids[i], snapshot->gpas[i]));
+  }
+  return students;
+}
@@ -0,0 +1,114 @@
+/*
+ * This file contains the definition of an interface for saving an array of
+ * students to a compact binary snapshot file and mapping that file back into
+ * memory without parsing it.
+ *
+ * A snapshot file is laid out column by column: a fixed-size header, the
+ * column of student IDs, the column of GPAs, a column of byte offsets into
+ * the name blob, and finally the name blob itself, in which every name is
+ * stored NUL-terminated.  Every section starts on an 8-byte boundary, so the
+ * columns can be used in place once the file is mapped.  Snapshots are
+ * written in the byte order of the host that saves them.
+ */
+
+#ifndef __STUDENT_SNAPSHOT_H
+#define __STUDENT_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * The version of the snapshot format written by save_student_array().
+ */
+#define STUDENT_SNAPSHOT_VERSION 1
+
+/*
+ * Structure used to represent a snapshot file mapped into memory.
+ */
+struct student_snapshot;
+
+/*
+ * Writes the students stored in a dynamic array to a snapshot file.  The
+ * file is first written under a temporary name and then renamed over path,
+ * so readers never observe a partially written snapshot.
+ *
+ * Params:
+ *   students - the dynamic array of students to be saved.  May not be NULL.
+ *   path - the path of the snapshot file to be written.  May not be NULL.
+ *
+ * Return:
+ *   Returns 0 on success or -1 if the file could not be written.
+ */
+int save_student_array(struct dynarray* students, const char* path);
+
+/*
+ * Maps a snapshot file written by save_student_array() into memory.  No
+ * records are parsed and no per-record memory is allocated; the returned
+ * snapshot reads its columns directly out of the mapping.
+ *
+ * Params:
+ *   path - the path of the snapshot file to be mapped.  May not be NULL.
+ *
+ * Return:
+ *   Returns the mapped snapshot, or NULL if the file could not be opened or
+ *   is not a valid snapshot of a supported version.
+ */
+struct student_snapshot* map_student_array(const char* path);
+
+/*
+ * Unmaps a snapshot and frees the memory associated with it.  Any names
+ * obtained from the snapshot (including those referenced by an array built
+ * with student_snapshot_to_array()) become invalid.
+ *
+ * Params:
+ *   snapshot - the snapshot to be unmapped.  May not be NULL.
+ */
+void unmap_student_array(struct student_snapshot* snapshot);
+
+/*
+ * Returns the number of students stored in a snapshot.
+ */
+int student_snapshot_size(struct student_snapshot* snapshot);
+
+/*
+ * Returns the ID of the idx'th student in a snapshot.  idx must be between 0
+ * and the size of the snapshot.
+ */
+int student_snapshot_id(struct student_snapshot* snapshot, int idx);
+
+/*
+ * Returns the GPA of the idx'th student in a snapshot.  idx must be between
+ * 0 and the size of the snapshot.
+ */
+float student_snapshot_gpa(struct student_snapshot* snapshot, int idx);
+
+/*
+ * Returns the name of the idx'th student in a snapshot.  The returned string
+ * points into the mapping and remains valid until the snapshot is unmapped.
+ */
+const char* student_snapshot_name(struct student_snapshot* snapshot, int idx);
+
+/*
+ * Return the whole ID and GPA columns of a snapshot.  Each column has
+ * student_snapshot_size() entries and remains valid until the snapshot is
+ * unmapped.
+ */
+const int32_t* student_snapshot_ids(struct student_snapshot* snapshot);
+const float* student_snapshot_gpas(struct student_snapshot* snapshot);
+
+/*
+ * Builds a dynamic array of student structs from a snapshot.  Names are not
+ * copied: each student's name points into the mapping, so the array must be
+ * freed with free_student_array() before the snapshot is unmapped.
+ *
+ * Params:
+ *   snapshot - the snapshot from which to build the array.  May not be NULL.
+ *
+ * Return:
+ *   Returns a newly-allocated dynamic array of students in snapshot order.
+ */
+struct dynarray* student_snapshot_to_array(struct student_snapshot* snapshot);
+
+#endif
@@ -0,0 +1,242 @@
+/*
+ * This file contains the definitions of functions implementing a stable
+ * multi-key sort of students.
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_sort.h"
+
+/*
+ * Runs shorter than this are sorted with insertion sort by the merge sort.
+ */
+#define SORT_INSERTION_THRESHOLD 16
+
+/*
+ * The number of bits sorted in each pass of the radix sort.
+ */
+#define SORT_RADIX_BITS 16
+#define SORT_RADIX_SIZE (1 << SORT_RADIX_BITS)
+
+/*
+ * Arrays shorter than this use the merge sort even when the keys could be
+ * packed, since clearing the radix counts would dominate.
+ */
+#define SORT_RADIX_THRESHOLD 1024
+
+/*
+ * This is an element of the radix sort: a student along with its packed key.
+ */
+struct sort_item {
+  uint64_t key;
+  struct student* student;
+};
+
+
+/*
+ * Auxilliary function mapping a numeric field of a student to an unsigned
+ * integer whose ordering matches the field's ordering in the requested
+ * direction.  Negative zero is treated as zero, as it is by comparisons.
+ */
+static uint32_t _sort_field_key(struct student* student,
+    const struct student_sort_key* key) {
+  uint32_t bits;
+  if (key->field == STUDENT_SORT_GPA) {
+    float gpa = student->gpa == 0.0f ? 0.0f : student->gpa;
+    memcpy(&bits, &gpa, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+  } else {
+    bits = (uint32_t)student->id ^ 0x80000000u;
+  }
+  return key->descending ? ~bits : bits;
+}
+
+
+/*
+ * Auxilliary function comparing two students by every key in turn.
+ */
+static int _sort_compare(struct student* a, struct student* b,
+    const struct student_sort_key* keys, int num_keys) {
+  for (int i = 0; i < num_keys; i++) {
+    int cmp;
+    if (keys[i].field == STUDENT_SORT_NAME) {
+      cmp = strcmp(a->name, b->name);
+      if (keys[i].descending) {
+        cmp = -cmp;
+      }
+    } else {
+      uint32_t x = _sort_field_key(a, &keys[i]);
+      uint32_t y = _sort_field_key(b, &keys[i]);
+      cmp = (x > y) - (x < y);
+    }
+    if (cmp) {
+      return cmp;
+    }
+  }
+  return 0;
+}
+
+
+/*
+ * Auxilliary function to stably sort items[lo, hi) using tmp as scratch
+ * space of the same size as items.
+ */
+static void _sort_merge(struct student** items, struct student** tmp, int lo,
+    int hi, const struct student_sort_key* keys, int num_keys) {
+  if (hi - lo <= SORT_INSERTION_THRESHOLD) {
+    for (int i = lo + 1; i < hi; i++) {
+      struct student* student = items[i];
+      int j = i;
+      while (j > lo &&
+          _sort_compare(items[j - 1], student, keys, num_keys) > 0) {
+        items[j] = items[j - 1];
+        j--;
+      }
+      items[j] = student;
+    }
+    return;
+  }
+
+  int mid = lo + (hi - lo) / 2;
+  _sort_merge(items, tmp, lo, mid, keys, num_keys);
+  _sort_merge(items, tmp, mid, hi, keys, num_keys);
+
+  /*
+   * If the halves are already in order there is nothing to merge.
+   */
+  if (_sort_compare(items[mid - 1], items[mid], keys, num_keys) <= 0) {
+    return;
+  }
+
+  memcpy(tmp + lo, items + lo, (hi - lo) * sizeof(struct student*));
+  int i = lo, j = mid, k = lo;
+  while (i < mid && j < hi) {
+    if (_sort_compare(tmp[j], tmp[i], keys, num_keys) < 0) {
+      items[k++] = tmp[j++];
+    } else {
+      items[k++] = tmp[i++];
+    }
+  }
+  while (i < mid) {
+    items[k++] = tmp[i++];
+  }
+  while (j < hi) {
+    items[k++] = tmp[j++];
+  }
+}
+
+
+/*
+ * Auxilliary function to stably sort items by key with an LSD radix sort.
+ * Passes in which every item has the same digit are skipped.
+ */
+static void _sort_radix(struct sort_item* items, int n, int key_bits) {
+  struct sort_item* sorted = items;
+  struct sort_item* tmp = malloc(n * sizeof(struct sort_item));
+  int* counts = malloc(SORT_RADIX_SIZE * sizeof(int));
+  assert(tmp && counts);
+
+  for (int shift = 0; shift < key_bits; shift += SORT_RADIX_BITS) {
+    memset(counts, 0, SORT_RADIX_SIZE * sizeof(int));
+    for (int i = 0; i < n; i++) {
+      counts[(items[i].key >> shift) & (SORT_RADIX_SIZE - 1)]++;
+    }
+    if (counts[(items[0].key >> shift) & (SORT_RADIX_SIZE - 1)] == n) {
+      continue;
+    }
+
+    int total = 0;
+    for (int d = 0; d < SORT_RADIX_SIZE; d++) {
+      int count = counts[d];
+      counts[d] = total;
+      total += count;
+    }
+    for (int i = 0; i < n; i++) {
+      tmp[counts[(items[i].key >> shift) & (SORT_RADIX_SIZE - 1)]++] = items[i];
+    }
+
+    struct sort_item* swap = items;
+    items = tmp;
+    tmp = swap;
+  }
+
+  /*
+   * After an odd number of passes the result is in the scratch buffer.
+   */
+  if (items != sorted) {
+    memcpy(sorted, items, n * sizeof(struct sort_item));
+    tmp = items;
+  }
+  free(counts);
+  free(tmp);
+}
+
+
+void sort_students(struct dynarray* students,
+    const struct student_sort_key* keys, int num_keys) {
+  assert(students && (keys || num_keys == 0));
+
+  int n = dynarray_size(students);
+  if (n < 2 || num_keys <= 0) {
+    return;
+  }
+
+  /*
+   * A repeated field can never break a tie left by its first occurrence, so
+   * only the first occurrence of each field matters, and there are at most
+   * three distinct fields.
+   */
+  struct student_sort_key used[3];
+  int num_used = 0, has_name = 0;
+  for (int i = 0; i < num_keys; i++) {
+    assert(keys[i].field == STUDENT_SORT_GPA ||
+      keys[i].field == STUDENT_SORT_ID || keys[i].field == STUDENT_SORT_NAME);
+    int seen = 0;
+    for (int j = 0; j < num_used; j++) {
+      seen |= used[j].field == keys[i].field;
+    }
+    if (!seen) {
+      assert(num_used < 3);
+      used[num_used++] = keys[i];
+      has_name |= keys[i].field == STUDENT_SORT_NAME;
+    }
+  }
+
+  if (!has_name && n >= SORT_RADIX_THRESHOLD) {
+    struct sort_item* items = malloc(n * sizeof(struct sort_item));
+    assert(items);
+    for (int i = 0; i < n; i++) {
+      struct student* student = dynarray_get(students, i);
+      items[i].student = student;
+      items[i].key = _sort_field_key(student, &used[0]);
+      if (num_used > 1) {
+        items[i].key =
+          (items[i].key << 32) | _sort_field_key(student, &used[1]);
+      }
+    }
+    _sort_radix(items, n, 32 * num_used);
+    for (int i = 0; i < n; i++) {
+      dynarray_set(students, i, items[i].student);
+    }
+    free(items);
+    return;
+  }
+
+  struct student** items = malloc(n * sizeof(struct student*));
+  struct student** tmp = malloc(n * sizeof(struct student*));
+  assert(items && tmp);
+  for (int i = 0; i < n; i++) {
+    items[i] = dynarray_get(students, i);
+  }
+  _sort_merge(items, tmp, 0, n, used, num_used);
+  for (int i = 0; i < n; i++) {
+    dynarray_set(students, i, items[i]);
+  }
+  free(tmp);
+  free(items);
+}
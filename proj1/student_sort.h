@@ -0,0 +1,50 @@
+/*
+ * This file contains the definition of an interface for sorting an array of
+ * students by several keys at once.
+ */
+
+#ifndef __STUDENT_SORT_H
+#define __STUDENT_SORT_H
+
+#include "dynarray.h"
+
+/*
+ * The student fields that can be used as sort keys.  Names are compared
+ * bytewise, as by strcmp().
+ */
+enum student_sort_field {
+  STUDENT_SORT_GPA,
+  STUDENT_SORT_ID,
+  STUDENT_SORT_NAME
+};
+
+/*
+ * A single sort key: the field to compare and whether to order that field
+ * from largest to smallest (descending != 0) or smallest to largest.
+ */
+struct student_sort_key {
+  enum student_sort_field field;
+  int descending;
+};
+
+/*
+ * Sorts the students in a dynamic array by an ordered list of keys: students
+ * are ordered by the first key, students that tie on the first key are
+ * ordered by the second key, and so on.  The sort is stable, so students
+ * that tie on every key keep their existing relative order.
+ *
+ * When only GPA and ID are used as keys, both are packed into one 64-bit
+ * integer per student and large arrays are sorted with a radix sort.
+ * Otherwise a merge sort is used.
+ *
+ * Params:
+ *   students - the dynamic array of students to be sorted.  May not be NULL.
+ *   keys - the sort keys, from most to least significant.  Each field must
+ *     be one of the values of enum student_sort_field.  A field that has
+ *     already appeared earlier in the list has no effect.
+ *   num_keys - the number of keys.  If this is 0, the array is unchanged.
+ */
+void sort_students(struct dynarray* students,
+    const struct student_sort_key* keys, int num_keys);
+
+#endif
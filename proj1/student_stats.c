@@ -0,0 +1,171 @@
+/*
+ * This file contains the definitions of functions computing GPA statistics
+ * over an array of students.  Each chunk of the array is summarized with
+ * Welford's method, and chunk summaries are merged pairwise with Chan's
+ * formula, which keeps the variance numerically stable.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <assert.h>
+#include <unistd.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_stats.h"
+#include "workers.h"
+
+/*
+ * The number of students summarized together in one chunk.  Chunk
+ * boundaries never depend on the number of threads.
+ */
+#define STATS_CHUNK_SIZE 65536
+
+/*
+ * This is the summary of one chunk.  m2 is the sum of squared differences
+ * from the chunk mean.
+ */
+struct stats_chunk {
+  int count;
+  float min;
+  float max;
+  int argmin;
+  int argmax;
+  double mean;
+  double m2;
+};
+
+/*
+ * This is the work description handed to each worker.  Worker t summarizes
+ * chunks t, t + num_threads, t + 2 * num_threads, and so on.
+ */
+struct stats_worker {
+  struct dynarray* students;
+  struct stats_chunk* chunks;
+  int num_chunks;
+  int first;
+  int stride;
+};
+
+
+/*
+ * Auxilliary function to summarize the students in [begin, end).
+ */
+static void _stats_summarize(struct dynarray* students, int begin, int end,
+    struct stats_chunk* chunk) {
+  struct student* student = dynarray_get(students, begin);
+  chunk->count = 0;
+  chunk->min = chunk->max = student->gpa;
+  chunk->argmin = chunk->argmax = begin;
+  chunk->mean = 0.0;
+  chunk->m2 = 0.0;
+
+  for (int i = begin; i < end; i++) {
+    student = dynarray_get(students, i);
+    float gpa = student->gpa;
+
+    if (gpa < chunk->min) {
+      chunk->min = gpa;
+      chunk->argmin = i;
+    }
+    if (gpa > chunk->max) {
+      chunk->max = gpa;
+      chunk->argmax = i;
+    }
+
+    chunk->count++;
+    double delta = gpa - chunk->mean;
+    chunk->mean += delta / chunk->count;
+    chunk->m2 += delta * (gpa - chunk->mean);
+  }
+}
+
+
+/*
+ * Auxilliary function to fold the summary of a later chunk into an earlier
+ * one.  Strict comparisons keep the first extreme on ties.
+ */
+static void _stats_merge(struct stats_chunk* into, struct stats_chunk* from) {
+  if (from->min < into->min) {
+    into->min = from->min;
+    into->argmin = from->argmin;
+  }
+  if (from->max > into->max) {
+    into->max = from->max;
+    into->argmax = from->argmax;
+  }
+
+  double count = (double)into->count + from->count;
+  double delta = from->mean - into->mean;
+  into->mean += delta * from->count / count;
+  into->m2 += from->m2 + delta * delta * into->count * from->count / count;
+  into->count += from->count;
+}
+
+
+/*
+ * Auxilliary function summarizing every stride'th chunk.
+ */
+static void _stats_worker_run(void* arg) {
+  struct stats_worker* worker = arg;
+  int n = dynarray_size(worker->students);
+  for (int c = worker->first; c < worker->num_chunks; c += worker->stride) {
+    int begin = c * STATS_CHUNK_SIZE;
+    int end = begin + STATS_CHUNK_SIZE < n ? begin + STATS_CHUNK_SIZE : n;
+    _stats_summarize(worker->students, begin, end, &worker->chunks[c]);
+  }
+}
+
+
+void student_gpa_stats(struct dynarray* students, int num_threads,
+    struct gpa_stats* stats) {
+  assert(students && stats);
+
+  int n = dynarray_size(students);
+  if (n == 0) {
+    stats->count = 0;
+    stats->min = stats->max = 0.0f;
+    stats->argmin = stats->argmax = -1;
+    stats->mean = stats->variance = 0.0;
+    return;
+  }
+
+  int num_chunks = (n + STATS_CHUNK_SIZE - 1) / STATS_CHUNK_SIZE;
+  if (num_threads <= 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = online > 0 ? (int)online : 1;
+  }
+  if (num_threads > num_chunks) {
+    num_threads = num_chunks;
+  }
+
+  struct stats_chunk* chunks = malloc(num_chunks * sizeof(struct stats_chunk));
+  struct stats_worker* workers = malloc(num_threads * sizeof(struct stats_worker));
+  assert(chunks && workers);
+
+  for (int t = 0; t < num_threads; t++) {
+    workers[t].students = students;
+    workers[t].chunks = chunks;
+    workers[t].num_chunks = num_chunks;
+    workers[t].first = t;
+    workers[t].stride = num_threads;
+  }
+  run_workers(workers, sizeof(struct stats_worker), num_threads,
+    _stats_worker_run);
+
+  for (int c = 1; c < num_chunks; c++) {
+    _stats_merge(&chunks[0], &chunks[c]);
+  }
+
+  stats->count = chunks[0].count;
+  stats->min = chunks[0].min;
+  stats->max = chunks[0].max;
+  stats->argmin = chunks[0].argmin;
+  stats->argmax = chunks[0].argmax;
+  stats->mean = chunks[0].mean;
+  stats->variance = chunks[0].m2 / chunks[0].count;
+
+  free(workers);
+  free(chunks);
+}
@@ -0,0 +1,44 @@
+/*
+ * This file contains the definition of an interface for computing summary
+ * statistics over the GPAs of an array of students in a single pass.
+ */
+
+#ifndef __STUDENT_STATS_H
+#define __STUDENT_STATS_H
+
+#include "dynarray.h"
+
+/*
+ * Structure holding GPA statistics.  argmin and argmax are the indices of the
+ * first student with the lowest and highest GPA, respectively, matching the
+ * students returned by find_min_gpa() and find_max_gpa().  variance is the
+ * population variance.  For an empty array, count is 0, argmin and argmax
+ * are -1, and every other field is 0.
+ */
+struct gpa_stats {
+  int count;
+  float min;
+  float max;
+  int argmin;
+  int argmax;
+  double mean;
+  double variance;
+};
+
+/*
+ * Computes the count, minimum, maximum, argmin, argmax, mean and variance of
+ * the GPAs of the students in a dynamic array in one pass.  The array is
+ * split into fixed-size chunks that are processed by worker threads, and the
+ * per-chunk results are always combined in array order, so the result does
+ * not depend on the number of threads used.
+ *
+ * Params:
+ *   students - the dynamic array of students.  May not be NULL.
+ *   num_threads - the number of threads to use.  If this is 0 or negative,
+ *     one thread per online processor is used.
+ *   stats - receives the computed statistics.  May not be NULL.
+ */
+void student_gpa_stats(struct dynarray* students, int num_threads,
+    struct gpa_stats* stats);
+
+#endif
@@ -0,0 +1,140 @@
+/*
+ * This file contains the definitions of functions that select the top or
+ * bottom k students by GPA.  Both use a bounded heap holding the k best
+ * students seen so far, with the worst of those at the root, so each student
+ * costs one comparison against the root and at most one O(log k) sift.  The
+ * whole selection runs in O(n log k) time and O(k) extra memory.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_topk.h"
+
+/*
+ * This is the definition of a single heap entry.  The GPA is copied into the
+ * entry so that sifting doesn't have to chase student pointers, and the
+ * position in the input array is used to break ties deterministically.
+ */
+struct topk_entry {
+  struct student* student;
+  float gpa;
+  int idx;
+};
+
+
+/*
+ * Auxilliary function that returns nonzero if entry a ranks strictly ahead
+ * of entry b.  direction is 1 when ranking by descending GPA and -1 when
+ * ranking by ascending GPA.  Earlier students win ties.
+ */
+static int _topk_better(struct topk_entry* a, struct topk_entry* b,
+    int direction) {
+  if (a->gpa != b->gpa) {
+    return direction > 0 ? a->gpa > b->gpa : a->gpa < b->gpa;
+  }
+  return a->idx < b->idx;
+}
+
+
+/*
+ * Auxilliary function to restore the heap property below node idx.  The
+ * heap keeps the entry that ranks last at the root.
+ */
+static void _topk_sift_down(struct topk_entry* heap, int size, int idx,
+    int direction) {
+  struct topk_entry entry = heap[idx];
+  while (2 * idx + 1 < size) {
+    int child = 2 * idx + 1;
+    if (child + 1 < size &&
+        _topk_better(&heap[child], &heap[child + 1], direction)) {
+      child++;
+    }
+    if (!_topk_better(&entry, &heap[child], direction)) {
+      break;
+    }
+    heap[idx] = heap[child];
+    idx = child;
+  }
+  heap[idx] = entry;
+}
+
+
+/*
+ * Auxilliary function to restore the heap property above node idx.
+ */
+static void _topk_sift_up(struct topk_entry* heap, int idx, int direction) {
+  struct topk_entry entry = heap[idx];
+  while (idx > 0) {
+    int parent = (idx - 1) / 2;
+    if (!_topk_better(&heap[parent], &entry, direction)) {
+      break;
+    }
+    heap[idx] = heap[parent];
+    idx = parent;
+  }
+  heap[idx] = entry;
+}
+
+
+/*
+ * Auxilliary function implementing both top_k_by_gpa() and bottom_k_by_gpa().
+ */
+static struct dynarray* _select_k_by_gpa(struct dynarray* students, int k,
+    int direction) {
+  assert(students);
+
+  int n = dynarray_size(students);
+  if (k > n) {
+    k = n;
+  }
+
+  struct dynarray* selected = dynarray_create();
+  if (k <= 0) {
+    return selected;
+  }
+
+  struct topk_entry* heap = malloc(k * sizeof(struct topk_entry));
+  assert(heap);
+
+  int size = 0;
+  for (int i = 0; i < n; i++) {
+    struct student* student = dynarray_get(students, i);
+    struct topk_entry entry = { student, student->gpa, i };
+    if (size < k) {
+      heap[size] = entry;
+      _topk_sift_up(heap, size++, direction);
+    } else if (_topk_better(&entry, &heap[0], direction)) {
+      heap[0] = entry;
+      _topk_sift_down(heap, size, 0, direction);
+    }
+  }
+
+  /*
+   * Pop the heap from worst to best, filling the array from the back, so the
+   * result ends up ordered best first.
+   */
+  for (int i = 0; i < k; i++) {
+    dynarray_insert(selected, -1, NULL);
+  }
+  while (size > 0) {
+    dynarray_set(selected, size - 1, heap[0].student);
+    heap[0] = heap[--size];
+    _topk_sift_down(heap, size, 0, direction);
+  }
+
+  free(heap);
+  return selected;
+}
+
+
+struct dynarray* top_k_by_gpa(struct dynarray* students, int k) {
+  return _select_k_by_gpa(students, k, 1);
+}
+
+
+struct dynarray* bottom_k_by_gpa(struct dynarray* students, int k) {
+  return _select_k_by_gpa(students, k, -1);
+}
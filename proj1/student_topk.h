@@ -0,0 +1,37 @@
+/*
+ * This file contains the definition of an interface for selecting the k
+ * students with the highest or lowest GPAs from a dynamic array without
+ * sorting the whole array.
+ */
+
+#ifndef __STUDENT_TOPK_H
+#define __STUDENT_TOPK_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * Returns the k students with the highest GPAs, ordered by descending GPA.
+ * Students with equal GPAs keep their relative order from the input array.
+ * The input array is not modified, and the returned array refers to the same
+ * student structs as the input, so only the returned array itself (and not
+ * the students in it) should be freed, using dynarray_free().
+ *
+ * Params:
+ *   students - the dynamic array of students to select from.  May not be
+ *     NULL.
+ *   k - the number of students to select.  If k is larger than the number of
+ *     students, all of them are returned.
+ *
+ * Return:
+ *   Returns a newly-allocated dynamic array holding at most k students.
+ */
+struct dynarray* top_k_by_gpa(struct dynarray* students, int k);
+
+/*
+ * Returns the k students with the lowest GPAs, ordered by ascending GPA.
+ * Otherwise this behaves exactly like top_k_by_gpa().
+ */
+struct dynarray* bottom_k_by_gpa(struct dynarray* students, int k);
+
+#endif
@@ -0,0 +1,296 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a name index as a radix tree (a trie in which chains of single-child nodes
+ * are collapsed into one node with a multi-byte edge label).  Each node keeps
+ * the first bytes of its children's labels in a small sorted array next to the
+ * child pointers, so picking the next child touches one cache line instead of
+ * every child node.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "students.h"
+#include "dynarray.h"
+#include "student_trie.h"
+
+/*
+ * This is the definition of a radix tree node.  label holds the bytes on the
+ * edge leading into the node.  first_bytes[i] is the first byte of
+ * children[i]'s label, and both arrays are sorted by that byte.  students
+ * holds the students whose names end exactly at this node, in insertion
+ * order.
+ */
+struct trie_node {
+  char* label;
+  int label_len;
+  unsigned char* first_bytes;
+  struct trie_node** children;
+  int num_children;
+  int children_cap;
+  struct student** students;
+  int num_students;
+  int students_cap;
+};
+
+/*
+ * This is the definition of the name index structure.
+ */
+struct student_trie {
+  struct trie_node* root;
+  int size;
+};
+
+
+/*
+ * Auxilliary function to allocate a node with a copy of the given label.
+ */
+static struct trie_node* _trie_node_create(const char* label, int label_len) {
+  struct trie_node* node = calloc(1, sizeof(struct trie_node));
+  assert(node);
+  node->label = malloc(label_len + 1);
+  assert(node->label);
+  memcpy(node->label, label, label_len);
+  node->label_len = label_len;
+  return node;
+}
+
+
+/*
+ * Auxilliary function to free a node and everything below it.
+ */
+static void _trie_node_free(struct trie_node* node) {
+  for (int i = 0; i < node->num_children; i++) {
+    _trie_node_free(node->children[i]);
+  }
+  free(node->label);
+  free(node->first_bytes);
+  free(node->children);
+  free(node->students);
+  free(node);
+}
+
+
+/*
+ * Auxilliary function to find the position of the child whose label starts
+ * with byte c.  Returns the index of that child, or -(insertion point) - 1
+ * if there is none.
+ */
+static int _trie_find_child(struct trie_node* node, unsigned char c) {
+  int lo = 0, hi = node->num_children;
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+    if (node->first_bytes[mid] < c) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo < node->num_children && node->first_bytes[lo] == c) {
+    return lo;
+  }
+  return -lo - 1;
+}
+
+
+/*
+ * Auxilliary function to insert a child at a given position.
+ */
+static void _trie_insert_child(struct trie_node* node, int pos,
+    struct trie_node* child) {
+  if (node->num_children == node->children_cap) {
+    node->children_cap = node->children_cap ? 2 * node->children_cap : 2;
+    node->first_bytes = realloc(node->first_bytes, node->children_cap);
+    node->children = realloc(node->children,
+      node->children_cap * sizeof(struct trie_node*));
+    assert(node->first_bytes && node->children);
+  }
+  memmove(node->first_bytes + pos + 1, node->first_bytes + pos,
+    node->num_children - pos);
+  memmove(node->children + pos + 1, node->children + pos,
+    (node->num_children - pos) * sizeof(struct trie_node*));
+  node->first_bytes[pos] = (unsigned char)child->label[0];
+  node->children[pos] = child;
+  node->num_children++;
+}
+
+
+/*
+ * Auxilliary function to record a student whose name ends at a node.
+ */
+static void _trie_add_student(struct trie_node* node,
+    struct student* student) {
+  if (node->num_students == node->students_cap) {
+    node->students_cap = node->students_cap ? 2 * node->students_cap : 1;
+    node->students = realloc(node->students,
+      node->students_cap * sizeof(struct student*));
+    assert(node->students);
+  }
+  node->students[node->num_students++] = student;
+}
+
+
+/*
+ * Auxilliary function returning the length of the common prefix of a
+ * node's label and the string s of length len.
+ */
+static int _trie_common_prefix(struct trie_node* node, const char* s,
+    int len) {
+  int max = node->label_len < len ? node->label_len : len;
+  int i = 0;
+  while (i < max && node->label[i] == s[i]) {
+    i++;
+  }
+  return i;
+}
+
+
+/*
+ * Auxilliary function to append every student in a subtree to out, in name
+ * order, stopping once *remaining reaches 0 (if it started positive).
+ */
+static int _trie_collect(struct trie_node* node, struct dynarray* out,
+    int* remaining) {
+  int added = 0;
+  for (int i = 0; i < node->num_students && *remaining != 0; i++) {
+    dynarray_insert(out, -1, node->students[i]);
+    (*remaining)--;
+    added++;
+  }
+  for (int i = 0; i < node->num_children && *remaining != 0; i++) {
+    added += _trie_collect(node->children[i], out, remaining);
+  }
+  return added;
+}
+
+
+struct student_trie* student_trie_create() {
+  struct student_trie* trie = malloc(sizeof(struct student_trie));
+  assert(trie);
+  trie->root = _trie_node_create("", 0);
+  trie->size = 0;
+  return trie;
+}
+
+
+void student_trie_free(struct student_trie* trie) {
+  assert(trie);
+  _trie_node_free(trie->root);
+  free(trie);
+}
+
+
+int student_trie_size(struct student_trie* trie) {
+  assert(trie);
+  return trie->size;
+}
+
+
+void student_trie_insert(struct student_trie* trie, struct student* student) {
+  assert(trie && student && student->name);
+
+  struct trie_node* node = trie->root;
+  const char* rest = student->name;
+  int rest_len = (int)strlen(rest);
+
+  while (rest_len > 0) {
+    int pos = _trie_find_child(node, (unsigned char)rest[0]);
+    if (pos < 0) {
+      /*
+       * No child shares even the first byte, so the rest of the name becomes
+       * a new leaf.
+       */
+      struct trie_node* leaf = _trie_node_create(rest, rest_len);
+      _trie_insert_child(node, -pos - 1, leaf);
+      node = leaf;
+      break;
+    }
+
+    struct trie_node* child = node->children[pos];
+    int common = _trie_common_prefix(child, rest, rest_len);
+    if (common < child->label_len) {
+      /*
+       * The name diverges from (or ends inside) the child's label, so split
+       * the label at the divergence point with a new intermediate node.
+       */
+      struct trie_node* split = _trie_node_create(child->label, common);
+      memmove(child->label, child->label + common, child->label_len - common);
+      child->label_len -= common;
+      _trie_insert_child(split, 0, child);
+      node->children[pos] = split;
+      child = split;
+    }
+
+    node = child;
+    rest += common;
+    rest_len -= common;
+  }
+
+  _trie_add_student(node, student);
+  trie->size++;
+}
+
+
+struct student_trie* student_trie_build(struct dynarray* students) {
+  assert(students);
+  struct student_trie* trie = student_trie_create();
+  int n = dynarray_size(students);
+  for (int i = 0; i < n; i++) {
+    student_trie_insert(trie, dynarray_get(students, i));
+  }
+  return trie;
+}
+
+
+struct student* student_trie_lookup(struct student_trie* trie,
+    const char* name) {
+  assert(trie && name);
+
+  struct trie_node* node = trie->root;
+  int len = (int)strlen(name);
+  while (len > 0) {
+    int pos = _trie_find_child(node, (unsigned char)name[0]);
+    if (pos < 0) {
+      return NULL;
+    }
+    node = node->children[pos];
+    if (node->label_len > len ||
+        memcmp(node->label, name, node->label_len) != 0) {
+      return NULL;
+    }
+    name += node->label_len;
+    len -= node->label_len;
+  }
+  return node->num_students ? node->students[0] : NULL;
+}
+
+
+int student_trie_find_prefix(struct student_trie* trie, const char* prefix,
+    struct dynarray* out, int limit) {
+  assert(trie && prefix && out);
+
+  struct trie_node* node = trie->root;
+  int len = (int)strlen(prefix);
+  while (len > 0) {
+    int pos = _trie_find_child(node, (unsigned char)prefix[0]);
+    if (pos < 0) {
+      return 0;
+    }
+    node = node->children[pos];
+
+    /*
+     * The prefix may end partway along this node's label, in which case the
+     * whole subtree matches.
+     */
+    int common = _trie_common_prefix(node, prefix, len);
+    if (common < node->label_len && common < len) {
+      return 0;
+    }
+    prefix += common;
+    len -= common;
+  }
+
+  int remaining = limit > 0 ? limit : -1;
+  return _trie_collect(node, out, &remaining);
+}
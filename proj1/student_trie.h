@@ -0,0 +1,92 @@
+/*
+ * This file contains the definition of an interface for an index of students
+ * by name that supports exact lookups and enumerating every student whose
+ * name starts with a given prefix.  The index does not own the students it
+ * refers to, and it assumes their names don't change while indexed.
+ */
+
+#ifndef __STUDENT_TRIE_H
+#define __STUDENT_TRIE_H
+
+#include "students.h"
+#include "dynarray.h"
+
+/*
+ * Structure used to represent a name index.
+ */
+struct student_trie;
+
+/*
+ * Creates a new, empty name index and returns a pointer to it.
+ */
+struct student_trie* student_trie_create();
+
+/*
+ * Free the memory associated with a name index.  The indexed students are
+ * not freed.
+ *
+ * Params:
+ *   trie - the index to be destroyed.  May not be NULL.
+ */
+void student_trie_free(struct student_trie* trie);
+
+/*
+ * Returns the number of students in a name index.
+ */
+int student_trie_size(struct student_trie* trie);
+
+/*
+ * Adds a student to a name index.  Several students may share a name.
+ *
+ * Params:
+ *   trie - the index into which to insert the student.  May not be NULL.
+ *   student - the student to be inserted.  May not be NULL.
+ */
+void student_trie_insert(struct student_trie* trie, struct student* student);
+
+/*
+ * Builds a name index over all of the students in a dynamic array.
+ *
+ * Params:
+ *   students - the dynamic array of students to be indexed.  May not be NULL.
+ *
+ * Return:
+ *   Returns a newly-allocated index over the students in the array.
+ */
+struct student_trie* student_trie_build(struct dynarray* students);
+
+/*
+ * Looks up a student by exact name.
+ *
+ * Params:
+ *   trie - the index in which to look up the name.  May not be NULL.
+ *   name - the name to look up.  May not be NULL.
+ *
+ * Return:
+ *   Returns the first student inserted with the given name, or NULL if there
+ *   is none.
+ */
+struct student* student_trie_lookup(struct student_trie* trie,
+    const char* name);
+
+/*
+ * Finds the students whose names start with a given prefix and appends them
+ * to a dynamic array, ordered by name (as by strcmp()) and, for equal names,
+ * by insertion order.
+ *
+ * Params:
+ *   trie - the index to search.  May not be NULL.
+ *   prefix - the name prefix.  May not be NULL; the empty prefix matches
+ *     every student.
+ *   out - the dynamic array to which matching students are appended.  May
+ *     not be NULL.
+ *   limit - the most students to append.  If this is 0 or negative, every
+ *     match is appended.
+ *
+ * Return:
+ *   Returns the number of students appended to out.
+ */
+int student_trie_find_prefix(struct student_trie* trie, const char* prefix,
+    struct dynarray* out, int limit);
+
+#endif
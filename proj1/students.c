@@ -9,11 +9,26 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include "students.h"
 #include "dynarray.h"
+#include "student_format.h"
+#include "pool.h"
 //#include "dynarray.c"
 
+/*
+* Student structs are allocated from this pool, which is created the first
+* time a student is.
+*/
+static struct pool* student_pool = NULL;
+static pthread_once_t student_pool_once = PTHREAD_ONCE_INIT;
+
+static void create_student_pool() {
+	student_pool = pool_create(sizeof(struct student));
+}
+
 /*
 * This function should allocate and initialize a single student struct with
 * name, ID, and GPA data.
@@ -30,7 +45,8 @@
 *   initialized with the values provided.
 */
 struct student* create_student(char* name, int id, float gpa) {
-	struct student *stud = malloc(sizeof(*stud));
+	pthread_once(&student_pool_once, create_student_pool);
+	struct student *stud = pool_alloc(student_pool);
 	stud->name = name;
 	stud->id = id;
 	stud->gpa = gpa;
@@ -49,7 +65,9 @@ struct student* create_student(char* name, int id, float gpa) {
 *     as well as memory allocated for the struct itself.
 */
 void free_student(struct student* student) {
-	free(student);
+	if (student) {
+		pool_release(student_pool, student);
+	}
 }
 
 
@@ -86,6 +104,7 @@ struct dynarray* create_student_array(int num_students, char** names, int* ids,
 	float* gpas) {
 
 	struct dynarray *sarray = dynarray_create();
+	dynarray_reserve(sarray, num_students);
 	for (int i = 0; i < num_students; i++) {
 		struct student *stud = create_student(names[i], ids[i], gpas[i]);
 		dynarray_insert(sarray, i, stud);
@@ -124,10 +143,12 @@ void free_student_array(struct dynarray* students) {
 *   students - the dynamic array of students to be printed
 */
 void print_students(struct dynarray* students) {
-	int x = dynarray_size(students);
-	for (int i = 0; i < x; i++) {
-	printf("  - name: %s\tid: %d\tgpa: %f\n", ((struct student *)dynarray_get(students, i))->name, ((struct student *)dynarray_get(students, i))->id, ((struct student *)dynarray_get(students, i))->gpa);
-	}
+	/*
+	* Flush anything already buffered in stdout first, so the rows written
+	* straight to the file descriptor come out in the right place.
+	*/
+	fflush(stdout);
+	write_students(students, STDOUT_FILENO, STUDENT_FORMAT_TEXT);
 }
 
 
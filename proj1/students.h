@@ -4,6 +4,9 @@
  * should not modify anything in this file.
  */
 
+#ifndef __STUDENTS_H
+#define __STUDENTS_H
+
 #include "dynarray.h"
 
 /*
@@ -30,3 +33,5 @@ void print_students(struct dynarray* students);
 struct student* find_max_gpa(struct dynarray* students);
 struct student* find_min_gpa(struct dynarray* students);
 void sort_by_gpa(struct dynarray* students);
+
+#endif
@@ -4,15 +4,114 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "students.h"
 #include "dynarray.h"
+#include "student_snapshot.h"
+#include "student_index.h"
+#include "student_topk.h"
+#include "student_stats.h"
+#include "student_collection.h"
+#include "student_sort.h"
+#include "student_trie.h"
+#include "student_query.h"
+#include "gpa_sketch.h"
+#include "student_join.h"
+#include "student_ingest.h"
+#include "student_format.h"
+#include "workers.h"
+#include "student_extsort.h"
 
 /*
  * This is the total number of students in the testing data set.
  */
 #define NUM_TESTING_STUDENTS 8
 
+/*
+ * This is the file used to test saving and mapping a student snapshot.
+ */
+#define SNAPSHOT_PATH "test_students.snapshot"
+
+/*
+ * These are the files and the number of students used to test the external
+ * sort.  With the smallest memory budget, this many students spill well over
+ * EXTSORT_MAX_FANIN runs, so the runs are merged in more than one pass.
+ */
+#define EXTSORT_IN_PATH "test_extsort_in.tmp"
+#define EXTSORT_OUT_PATH "test_extsort_out.tmp"
+
+/*
+ * This is the temporary file students are written to in TSV format, and the
+ * length of a name too long to fit in write_students()' buffer.
+ */
+#define TSV_PATH "test_students.tsv.tmp"
+#define TSV_LONG_NAME_LEN (2 << 20)
+#define NUM_EXTSORT_STUDENTS 200000
+
+/*
+ * This is the number of students used to compare the radix sort in
+ * sort_students(), which is only used for arrays at least this large, with
+ * its merge sort.
+ */
+#define NUM_RADIX_STUDENTS 5000
+
+/*
+ * This is the number of students used to compare queries over a snapshot
+ * with queries over an array.  It is not a multiple of four, so the
+ * snapshot query's vectorized loop leaves a few rows for its scalar tail.
+ */
+#define NUM_QUERY_STUDENTS 4999
+
+/*
+ * This is the number of students in the smaller input of the large join.
+ * It is above JOIN_PARTITION_THRESHOLD, so join_students_by_id() uses the
+ * radix-partitioned join.
+ */
+#define NUM_JOIN_STUDENTS 70000
+
+/*
+ * These are the number of students put in each small index to test removal
+ * and the number of rounds of that test.  An index created for this many
+ * students has 16 slots, so it is nearly full and its clusters often run
+ * past the end of the slot array and wrap around to the start.
+ */
+#define NUM_INDEX_STUDENTS 14
+#define NUM_INDEX_ROUNDS 200
+
+/*
+ * This is the number of students used to compare GPA statistics computed
+ * with different numbers of threads.  It spans three statistics chunks.
+ */
+#define NUM_STATS_STUDENTS (3 * 65536)
+
+/*
+ * This is the number of students built with several threads.  It's large
+ * enough for three slices, and the slices don't divide it evenly.
+ */
+#define NUM_INGEST_STUDENTS (3 * INGEST_MIN_SLICE + 1001)
+
+/*
+ * These are the number of threads allocating and releasing students and the
+ * number of students each of them allocates per round.
+ */
+#define NUM_POOL_THREADS 4
+#define NUM_POOL_STUDENTS 1000
+
+/*
+ * This is the work of one thread allocating and releasing students: it frees
+ * the students in release, which another thread allocated, and allocates new
+ * students into create, with IDs starting at first_id.
+ */
+struct pool_job {
+  struct student** release;
+  struct student** create;
+  int first_id;
+};
+
 
 /*
  * These are the names of the students that'll be used for testing.
@@ -60,6 +159,306 @@ float TESTING_GPAS[] = {
 };
 
 
+/*
+ * This function is called by join_students_by_id() for each matching pair of
+ * students.  It prints the pair.
+ */
+void print_joined_students(struct student* a, struct student* b, void* arg) {
+  printf("  - id: %d\tname: %s\tgpa: %f\tnew gpa: %f\n", a->id, a->name,
+    a->gpa, b->gpa);
+}
+
+
+/*
+ * This function reads back a file of STUDENT_FORMAT_BINARY records written by
+ * external_sort_by_gpa() for students whose IDs were their input positions.
+ * It counts the records and checks that GPAs never increase and that
+ * students with equal GPAs are still in input order.
+ */
+void check_sorted_students(const char* path, int* count, int* ordered,
+    int* stable) {
+  FILE* file = fopen(path, "rb");
+  int32_t id, prev_id = -1;
+  float gpa, prev_gpa = 0;
+  uint32_t name_len;
+  char name[64];
+
+  *count = 0;
+  *ordered = *stable = file != NULL;
+  while (file && fread(&id, sizeof(id), 1, file) == 1 &&
+      fread(&gpa, sizeof(gpa), 1, file) == 1 &&
+      fread(&name_len, sizeof(name_len), 1, file) == 1 &&
+      name_len <= sizeof(name) &&
+      fread(name, 1, name_len, file) == name_len) {
+    if (*count > 0 && gpa > prev_gpa) {
+      *ordered = 0;
+    }
+    if (*count > 0 && gpa == prev_gpa && id < prev_id) {
+      *stable = 0;
+    }
+    prev_id = id;
+    prev_gpa = gpa;
+    (*count)++;
+  }
+  if (file) {
+    fclose(file);
+  }
+}
+
+
+/*
+ * This function creates n students with the testing names and a few distinct
+ * GPAs.  IDs are unique, decrease through the array and run from positive to
+ * negative, so students that tie on GPA are in descending ID order.
+ */
+struct dynarray* create_many_students(int n) {
+  char** names = malloc(n * sizeof(char*));
+  int* ids = malloc(n * sizeof(int));
+  float* gpas = malloc(n * sizeof(float));
+  for (int i = 0; i < n; i++) {
+    names[i] = TESTING_NAMES[i % NUM_TESTING_STUDENTS];
+    ids[i] = n / 2 - i;
+    gpas[i] = (i * 5 % 7) * 0.5;
+  }
+  struct dynarray* students = create_student_array(n, names, ids, gpas);
+  free(gpas);
+  free(ids);
+  free(names);
+  return students;
+}
+
+
+/*
+ * This function sorts two copies of NUM_RADIX_STUDENTS students from
+ * create_many_students(), one by keys that sort_students() handles with its
+ * radix sort and one by keys that force its merge sort but order the
+ * students the same way.  It returns 1 if both copies end up in the same
+ * order.
+ */
+int radix_matches_merge(const struct student_sort_key* radix_keys,
+    int num_radix_keys, const struct student_sort_key* merge_keys,
+    int num_merge_keys) {
+  struct dynarray* radix = create_many_students(NUM_RADIX_STUDENTS);
+  struct dynarray* merge = create_many_students(NUM_RADIX_STUDENTS);
+  sort_students(radix, radix_keys, num_radix_keys);
+  sort_students(merge, merge_keys, num_merge_keys);
+
+  int same = 1;
+  for (int i = 0; i < NUM_RADIX_STUDENTS; i++) {
+    struct student* a = dynarray_get(radix, i);
+    struct student* b = dynarray_get(merge, i);
+    same &= a->id == b->id;
+  }
+  free_student_array(merge);
+  free_student_array(radix);
+  return same;
+}
+
+
+/*
+ * This function evaluates a query over an array of students and over a
+ * snapshot of the same array.  It returns the number of matches if both
+ * select the same students, or -1 if they differ or the snapshot can't be
+ * saved and mapped.
+ */
+int snapshot_query_matches_array(struct student_query* query,
+    struct dynarray* students) {
+  int n = dynarray_size(students);
+  int* expected = malloc((n + 1) * sizeof(int));
+  int* selection = malloc((n + 1) * sizeof(int));
+  int count = student_query_select(query, students, expected);
+
+  struct student_snapshot* snapshot = NULL;
+  if (save_student_array(students, SNAPSHOT_PATH) == 0) {
+    snapshot = map_student_array(SNAPSHOT_PATH);
+    remove(SNAPSHOT_PATH);
+  }
+  int result = -1;
+  if (snapshot) {
+    if (student_query_select_snapshot(query, snapshot, selection) == count) {
+      result = count;
+      for (int i = 0; i < count; i++) {
+        if (selection[i] != expected[i]) {
+          result = -1;
+        }
+      }
+    }
+    unmap_student_array(snapshot);
+  }
+  free(selection);
+  free(expected);
+  return result;
+}
+
+
+/*
+ * This function is called by join_students_by_id() for each matching pair of
+ * students.  It adds a checksum of the pair to the long long pointed to by
+ * arg: the ID of the first student weighted by the GPA of the second.
+ */
+void sum_joined_students(struct student* a, struct student* b, void* arg) {
+  *(long long*)arg += (long long)a->id * (long long)(b->gpa * 2 + 1);
+}
+
+
+/*
+ * This function fills a small student index, removes its students one at a
+ * time in a scrambled order, and after each removal looks up every student
+ * again.  It returns 1 if every lookup and removal gave the right result.
+ */
+int index_removals_correct(int round) {
+  struct student* students[NUM_INDEX_STUDENTS];
+  struct student_index* index = student_index_create(NUM_INDEX_STUDENTS);
+  int present[NUM_INDEX_STUDENTS];
+  int correct = 1;
+
+  for (int i = 0; i < NUM_INDEX_STUDENTS; i++) {
+    students[i] = create_student(TESTING_NAMES[i % NUM_TESTING_STUDENTS],
+      round * 1000 + i, 3.0);
+    student_index_insert(index, students[i]);
+    present[i] = 1;
+  }
+
+  for (int r = 0; r < NUM_INDEX_STUDENTS; r++) {
+    int victim = (r * 5 + round) % NUM_INDEX_STUDENTS;
+    correct &= student_index_remove(index, students[victim]->id) ==
+      students[victim];
+    correct &= student_index_remove(index, students[victim]->id) == NULL;
+    present[victim] = 0;
+    for (int i = 0; i < NUM_INDEX_STUDENTS; i++) {
+      struct student* found = student_index_lookup(index, students[i]->id);
+      correct &= found == (present[i] ? students[i] : NULL);
+    }
+    correct &= student_index_size(index) == NUM_INDEX_STUDENTS - r - 1;
+  }
+
+  student_index_free(index);
+  for (int i = 0; i < NUM_INDEX_STUDENTS; i++) {
+    free_student(students[i]);
+  }
+  return correct;
+}
+
+
+/*
+ * This function returns 1 if two sets of GPA statistics are identical bit
+ * for bit, field by field.
+ */
+int same_gpa_stats(struct gpa_stats* a, struct gpa_stats* b) {
+  return a->count == b->count && a->argmin == b->argmin &&
+    a->argmax == b->argmax &&
+    memcmp(&a->min, &b->min, sizeof(a->min)) == 0 &&
+    memcmp(&a->max, &b->max, sizeof(a->max)) == 0 &&
+    memcmp(&a->mean, &b->mean, sizeof(a->mean)) == 0 &&
+    memcmp(&a->variance, &b->variance, sizeof(a->variance)) == 0;
+}
+
+
+/*
+ * This function returns 1 if two arrays hold the same students in the same
+ * order.
+ */
+int same_students(struct dynarray* a, struct dynarray* b) {
+  if (dynarray_size(a) != dynarray_size(b)) {
+    return 0;
+  }
+  for (int i = 0; i < dynarray_size(a); i++) {
+    struct student* x = dynarray_get(a, i);
+    struct student* y = dynarray_get(b, i);
+    if (!x || !y || x->id != y->id || x->gpa != y->gpa ||
+        strcmp(x->name, y->name) != 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+
+/*
+ * This function returns 1 if the highest and lowest GPAs maintained by a
+ * collection are the students found by find_max_gpa() and find_min_gpa().
+ */
+int collection_extremes_correct(struct student_collection* collection) {
+  struct dynarray* students = student_collection_array(collection);
+  return student_collection_max_gpa(collection) == find_max_gpa(students) &&
+    student_collection_min_gpa(collection) == find_min_gpa(students);
+}
+
+
+/*
+ * This function returns the index of a student in a collection.
+ */
+int collection_index_of(struct student_collection* collection,
+    struct student* student) {
+  int i;
+  for (i = 0; student_collection_get(collection, i) != student; i++);
+  return i;
+}
+
+
+/*
+ * This function runs one pool_job.
+ */
+void run_pool_job(void* arg) {
+  struct pool_job* job = arg;
+  for (int i = 0; job->release && i < NUM_POOL_STUDENTS; i++) {
+    free_student(job->release[i]);
+  }
+  for (int i = 0; i < NUM_POOL_STUDENTS; i++) {
+    job->create[i] = create_student(TESTING_NAMES[i % NUM_TESTING_STUDENTS],
+      job->first_id + i, i);
+  }
+}
+
+
+/*
+ * This function writes an array of students to a file in TSV format and
+ * returns 1 if the file holds exactly the header line followed by one
+ * "name\tid\tgpa" line per student.
+ */
+int tsv_matches_students(struct dynarray* students) {
+  int fd = open(TSV_PATH, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return 0;
+  }
+  int status = write_students(students, fd, STUDENT_FORMAT_TSV);
+  close(fd);
+
+  FILE* file = fopen(TSV_PATH, "r");
+  remove(TSV_PATH);
+  if (status != 0 || !file) {
+    if (file) {
+      fclose(file);
+    }
+    return 0;
+  }
+
+  size_t max_len = 64;
+  for (int i = 0; i < dynarray_size(students); i++) {
+    struct student* student = dynarray_get(students, i);
+    if (strlen(student->name) + 64 > max_len) {
+      max_len = strlen(student->name) + 64;
+    }
+  }
+  char* expected = malloc(max_len);
+  char* line = malloc(max_len);
+
+  int matches = fgets(line, max_len, file) && !strcmp(line, "name\tid\tgpa\n");
+  for (int i = 0; matches && i < dynarray_size(students); i++) {
+    struct student* student = dynarray_get(students, i);
+    snprintf(expected, max_len, "%s\t%d\t%f\n", student->name, student->id,
+      student->gpa);
+    matches = fgets(line, max_len, file) && !strcmp(line, expected);
+  }
+  matches = matches && fgetc(file) == EOF;
+
+  free(line);
+  free(expected);
+  fclose(file);
+  return matches;
+}
+
+
 int main(int argc, char** argv) {
   struct student* s = NULL;
   struct dynarray* students;
@@ -90,6 +489,28 @@ int main(int argc, char** argv) {
   printf("\n== Here are the results of create_student_array():\n");
   print_students(students);
 
+  /*
+   * Write the same students in TSV format, then check the TSV output of
+   * students with negative IDs, a name with spaces, and a name longer than
+   * the writer's buffer.
+   */
+  printf("\n== Here are the same students in TSV format:\n");
+  fflush(stdout);
+  write_students(students, STDOUT_FILENO, STUDENT_FORMAT_TSV);
+
+  char* long_name = malloc(TSV_LONG_NAME_LEN + 1);
+  memset(long_name, 'x', TSV_LONG_NAME_LEN);
+  long_name[TSV_LONG_NAME_LEN] = '\0';
+  struct dynarray* tsv_students = create_student_array(NUM_TESTING_STUDENTS,
+    TESTING_NAMES, TESTING_IDS, TESTING_GPAS);
+  dynarray_insert(tsv_students, -1,
+    create_student("Jar Jar Binks", -42, 0.125));
+  dynarray_insert(tsv_students, -1, create_student(long_name, 7, 2.5));
+  printf("  - TSV output matches the students: %s\n",
+    tsv_matches_students(tsv_students) ? "yes" : "no");
+  free_student_array(tsv_students);
+  free(long_name);
+
   /*
    * Use find_max_gpa() to find the student with the highest GPA and print
    * the result.
@@ -122,6 +543,484 @@ int main(int argc, char** argv) {
   printf("\n== Here are the students ordered by decreasing GPA:\n");
   print_students(students);
 
+  /*
+   * Save the sorted array to a binary snapshot, map it back into memory, and
+   * print the students read straight out of the mapping.
+   */
+  printf("\n== Here are the students read back from a binary snapshot:\n");
+  if (save_student_array(students, SNAPSHOT_PATH) == 0) {
+    struct student_snapshot* snapshot = map_student_array(SNAPSHOT_PATH);
+    if (snapshot) {
+      for (i = 0; i < student_snapshot_size(snapshot); i++) {
+        printf("  - name: %s\tid: %d\tgpa: %f\n",
+          student_snapshot_name(snapshot, i), student_snapshot_id(snapshot, i),
+          student_snapshot_gpa(snapshot, i));
+      }
+      unmap_student_array(snapshot);
+    } else {
+      printf("  - NULL\n");
+    }
+    remove(SNAPSHOT_PATH);
+  } else {
+    printf("  - NULL\n");
+  }
+
+  /*
+   * Write a large array of students to a binary record file, sort it with
+   * external_sort_by_gpa() using the smallest memory budget, and check the
+   * sorted file.  There are only a few distinct GPAs, so most students tie
+   * with others and the ties must come out in input order.
+   */
+  char** extsort_names = malloc(NUM_EXTSORT_STUDENTS * sizeof(char*));
+  int* extsort_ids = malloc(NUM_EXTSORT_STUDENTS * sizeof(int));
+  float* extsort_gpas = malloc(NUM_EXTSORT_STUDENTS * sizeof(float));
+  for (i = 0; i < NUM_EXTSORT_STUDENTS; i++) {
+    extsort_names[i] = TESTING_NAMES[i % NUM_TESTING_STUDENTS];
+    extsort_ids[i] = i;
+    extsort_gpas[i] = (i * 7 % 9) * 0.5;
+  }
+  struct dynarray* extsort_students = create_student_array(
+    NUM_EXTSORT_STUDENTS, extsort_names, extsort_ids, extsort_gpas);
+  free(extsort_gpas);
+  free(extsort_ids);
+  free(extsort_names);
+
+  printf("\n== Here are the results of external_sort_by_gpa():\n");
+  int status = -1;
+  int fd = open(EXTSORT_IN_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd >= 0) {
+    status = write_students(extsort_students, fd, STUDENT_FORMAT_BINARY);
+    if (close(fd) != 0) {
+      status = -1;
+    }
+  }
+  if (status == 0) {
+    status = external_sort_by_gpa(EXTSORT_IN_PATH, EXTSORT_OUT_PATH, 0);
+  }
+  if (status == 0) {
+    int count, ordered, stable;
+    check_sorted_students(EXTSORT_OUT_PATH, &count, &ordered, &stable);
+    printf("  - students: %d\tin GPA order: %s\tequal GPAs stable: %s\n",
+      count, ordered ? "yes" : "no", stable ? "yes" : "no");
+  } else {
+    printf("  - sort failed\n");
+  }
+  remove(EXTSORT_OUT_PATH);
+  remove(EXTSORT_IN_PATH);
+  free_student_array(extsort_students);
+
+  /*
+   * Build an index over the array with student_index_build() and use it to
+   * look up a student by ID.
+   */
+  struct student_index* index = student_index_build(students);
+  s = student_index_lookup(index, TESTING_IDS[2]);
+  printf("\n== Here's the student with ID %d:\n", TESTING_IDS[2]);
+  if (s) {
+    printf("  - name: %s\tid: %d\tgpa: %f\n", s->name, s->id, s->gpa);
+  } else {
+    printf("  - NULL\n");
+  }
+  printf("  - inserting a duplicate ID %s\n",
+    student_index_insert(index, s) ? "succeeded" : "was rejected");
+  student_index_free(index);
+
+  /*
+   * Remove students from nearly full indexes with student_index_remove(),
+   * checking every lookup after each removal.
+   */
+  int removals_correct = 1;
+  for (i = 0; i < NUM_INDEX_ROUNDS; i++) {
+    removals_correct &= index_removals_correct(i);
+  }
+  printf("\n== Here's whether removing students from an index works:\n");
+  printf("  - lookups after %d removals are correct: %s\n",
+    NUM_INDEX_ROUNDS * NUM_INDEX_STUDENTS, removals_correct ? "yes" : "no");
+
+  /*
+   * Build an array with create_indexed_student_array() from input in which
+   * Han Solo's ID appears again as a second "Chewbacca".  Only the first
+   * student with that ID is kept.
+   */
+  char* dup_names[] = { "Han Solo", "Chewbacca", "Chewbacca" };
+  int dup_ids[] = { TESTING_IDS[3], TESTING_IDS[2], TESTING_IDS[3] };
+  float dup_gpas[] = { TESTING_GPAS[3], TESTING_GPAS[2], 4.0 };
+  struct dynarray* indexed = create_indexed_student_array(3, dup_names,
+    dup_ids, dup_gpas, &index);
+  printf("\n== Here are the results of create_indexed_student_array() with a duplicate ID:\n");
+  print_students(indexed);
+  s = student_index_lookup(index, TESTING_IDS[3]);
+  printf("  - student with ID %d: %s\n", TESTING_IDS[3], s ? s->name : "NULL");
+  student_index_free(index);
+  free_student_array(indexed);
+
+  /*
+   * Use top_k_by_gpa() and bottom_k_by_gpa() to select the three students
+   * with the highest and lowest GPAs and print the results.
+   */
+  struct dynarray* selected = top_k_by_gpa(students, 3);
+  printf("\n== Here are the 3 students with the highest GPAs:\n");
+  print_students(selected);
+  dynarray_free(selected);
+
+  selected = bottom_k_by_gpa(students, 3);
+  printf("\n== Here are the 3 students with the lowest GPAs:\n");
+  print_students(selected);
+  dynarray_free(selected);
+
+  /*
+   * Use student_gpa_stats() to summarize all of the GPAs in one pass and
+   * print the results.
+   */
+  struct gpa_stats stats;
+  student_gpa_stats(students, 0, &stats);
+  printf("\n== Here are the GPA statistics for all students:\n");
+  printf("  - count: %d\tmin: %f\tmax: %f\n", stats.count, stats.min,
+    stats.max);
+  printf("  - mean: %f\tvariance: %f\n", stats.mean, stats.variance);
+
+  /*
+   * Compute the statistics of an array spanning several chunks with 1, 2
+   * and 8 threads.  Chunk boundaries and the merge order don't depend on the
+   * number of threads, so the results must be identical bit for bit.
+   */
+  char** stats_names = malloc(NUM_STATS_STUDENTS * sizeof(char*));
+  int* stats_ids = malloc(NUM_STATS_STUDENTS * sizeof(int));
+  float* stats_gpas = malloc(NUM_STATS_STUDENTS * sizeof(float));
+  for (i = 0; i < NUM_STATS_STUDENTS; i++) {
+    stats_names[i] = TESTING_NAMES[i % NUM_TESTING_STUDENTS];
+    stats_ids[i] = i;
+    stats_gpas[i] = (i * 7919 % 4001) / 1000.0;
+  }
+  struct dynarray* stats_students = create_student_array(NUM_STATS_STUDENTS,
+    stats_names, stats_ids, stats_gpas);
+  free(stats_gpas);
+  free(stats_ids);
+  free(stats_names);
+
+  struct gpa_stats one_thread, threaded;
+  int stats_match = 1;
+  student_gpa_stats(stats_students, 1, &one_thread);
+  student_gpa_stats(stats_students, 2, &threaded);
+  stats_match &= same_gpa_stats(&one_thread, &threaded);
+  student_gpa_stats(stats_students, 8, &threaded);
+  stats_match &= same_gpa_stats(&one_thread, &threaded);
+  printf("  - %d students: count: %d\tmin: %f\tmax: %f\tmean: %f\n",
+    NUM_STATS_STUDENTS, one_thread.count, one_thread.min, one_thread.max,
+    one_thread.mean);
+  printf("  - 1, 2 and 8 threads agree bit for bit: %s\n",
+    stats_match ? "yes" : "no");
+  free_student_array(stats_students);
+
+  /*
+   * Build a student collection, remove the student with the highest GPA, and
+   * print the new highest and lowest GPAs maintained by the collection.
+   */
+  struct student_collection* collection = student_collection_create();
+  for (i = 0; i < NUM_TESTING_STUDENTS; i++) {
+    student_collection_add(collection, create_student(TESTING_NAMES[i],
+      TESTING_IDS[i], TESTING_GPAS[i]));
+  }
+  s = student_collection_max_gpa(collection);
+  for (i = 0; student_collection_get(collection, i) != s; i++);
+  free_student(student_collection_remove(collection, i));
+  printf("\n== Here are the highest and lowest GPAs after removing the top student:\n");
+  s = student_collection_max_gpa(collection);
+  printf("  - name: %s\tid: %d\tgpa: %f\n", s->name, s->id, s->gpa);
+  s = student_collection_min_gpa(collection);
+  printf("  - name: %s\tid: %d\tgpa: %f\n", s->name, s->id, s->gpa);
+  printf("  - students with GPAs between 3.00 and 3.75: %d\n",
+    student_collection_count_in_gpa_range(collection, 3.0, 3.75));
+  printf("  - median GPA: %f\n",
+    student_collection_gpa_percentile(collection, 50.0));
+
+  /*
+   * Change GPAs so that the highest and lowest GPAs are raised past, lowered
+   * below or tied with the others, and compare the collection's extremes with
+   * find_max_gpa() and find_min_gpa() after each change.
+   */
+  printf("\n== Here's whether the highest and lowest GPAs follow GPA changes:\n");
+  student_collection_set_gpa(collection, 2, 4.5);
+  printf("  - after raising a GPA above the highest: %s\n",
+    collection_extremes_correct(collection) ? "yes" : "no");
+  i = collection_index_of(collection, student_collection_max_gpa(collection));
+  student_collection_set_gpa(collection, i, 2.0);
+  printf("  - after lowering the highest GPA below others: %s\n",
+    collection_extremes_correct(collection) ? "yes" : "no");
+  i = collection_index_of(collection, student_collection_min_gpa(collection));
+  student_collection_set_gpa(collection, i, 3.95);
+  printf("  - after raising the lowest GPA above others: %s\n",
+    collection_extremes_correct(collection) ? "yes" : "no");
+  i = collection_index_of(collection, student_collection_min_gpa(collection));
+  student_collection_set_gpa(collection, i, 0.5);
+  printf("  - after lowering the lowest GPA further: %s\n",
+    collection_extremes_correct(collection) ? "yes" : "no");
+  i = collection_index_of(collection, student_collection_max_gpa(collection));
+  student_collection_set_gpa(collection, i, 0.5);
+  printf("  - after lowering the highest GPA to tie with the lowest: %s\n",
+    collection_extremes_correct(collection) ? "yes" : "no");
+  student_collection_set_gpa(collection, 0, 4.0);
+  student_collection_set_gpa(collection, 1, 4.0);
+  printf("  - after tying two GPAs at the top: %s\n",
+    collection_extremes_correct(collection) ? "yes" : "no");
+  student_collection_free(collection);
+
+  /*
+   * Use sort_students() to order the students by name and then by ID and
+   * print the results.
+   */
+  struct student_sort_key keys[] = {
+    { STUDENT_SORT_NAME, 0 },
+    { STUDENT_SORT_ID, 0 }
+  };
+  sort_students(students, keys, 2);
+  printf("\n== Here are the students ordered by name and then ID:\n");
+  print_students(students);
+
+  /*
+   * Sort a large array with sort_students() by keys that use its radix sort
+   * and check the result against its merge sort.  IDs are unique, so adding
+   * a name key after them changes nothing but the algorithm.  Sorting by GPA
+   * alone checks that the radix sort is stable: ties must stay in
+   * descending ID order.
+   */
+  struct student_sort_key radix_keys[] = {
+    { STUDENT_SORT_GPA, 1 },
+    { STUDENT_SORT_ID, 0 }
+  };
+  struct student_sort_key merge_keys[] = {
+    { STUDENT_SORT_GPA, 1 },
+    { STUDENT_SORT_ID, 0 },
+    { STUDENT_SORT_NAME, 0 }
+  };
+  printf("\n== Here's whether the radix sort matches the merge sort for %d students:\n",
+    NUM_RADIX_STUDENTS);
+  printf("  - GPA then ID: %s\n",
+    radix_matches_merge(radix_keys, 2, merge_keys, 3) ? "yes" : "no");
+  radix_keys[0].descending = merge_keys[0].descending = 0;
+  merge_keys[1].descending = 1;
+  printf("  - GPA only: %s\n",
+    radix_matches_merge(radix_keys, 1, merge_keys, 3) ? "yes" : "no");
+
+  /*
+   * Build a name index with student_trie_build() and use it to find every
+   * student whose name starts with "L".
+   */
+  struct student_trie* trie = student_trie_build(students);
+  selected = dynarray_create();
+  student_trie_find_prefix(trie, "L", selected, 0);
+  printf("\n== Here are the students whose names start with \"L\":\n");
+  print_students(selected);
+  dynarray_free(selected);
+  student_trie_free(trie);
+
+  /*
+   * Use student_query_select() to find the students with GPAs between 3.0
+   * and 4.0 whose names start with "C" and print the results.
+   */
+  struct student_query query;
+  int selection[NUM_TESTING_STUDENTS];
+  student_query_init(&query);
+  student_query_gpa_between(&query, 3.0, 4.0);
+  student_query_name_prefix(&query, "C");
+  int num_selected = student_query_select(&query, students, selection);
+  printf("\n== Here are the students with GPAs in [3.0, 4.0] whose names start with \"C\":\n");
+  for (i = 0; i < num_selected; i++) {
+    s = dynarray_get(students, selection[i]);
+    printf("  - name: %s\tid: %d\tgpa: %f\n", s->name, s->id, s->gpa);
+  }
+
+  /*
+   * Evaluate queries with student_query_select_snapshot() over snapshots of
+   * the testing students and of a larger array, and check that they select
+   * the same students as student_query_select() does over the arrays.
+   */
+  printf("\n== Here are the numbers of snapshot query matches (-1 if they differ from the array):\n");
+  printf("  - GPAs in [3.0, 4.0], names starting with \"C\": %d\n",
+    snapshot_query_matches_array(&query, students));
+  struct dynarray* many = create_many_students(NUM_QUERY_STUDENTS);
+  student_query_init(&query);
+  student_query_gpa_between(&query, 1.0, 2.5);
+  student_query_id_between(&query, -2500, 1999);
+  printf("  - %d students, GPAs in [1.0, 2.5], IDs in [-2500, 1999]: %d\n",
+    NUM_QUERY_STUDENTS, snapshot_query_matches_array(&query, many));
+  student_query_name_prefix(&query, "Han");
+  printf("  - the same with names starting with \"Han\": %d\n",
+    snapshot_query_matches_array(&query, many));
+  free_student_array(many);
+
+  /*
+   * Summarize the GPAs with a quantile sketch and print the median and 90th
+   * percentile GPAs it reports.
+   */
+  struct gpa_sketch* sketch = gpa_sketch_create(GPA_SKETCH_DEFAULT_K);
+  gpa_sketch_add_students(sketch, students);
+  printf("\n== Here are the GPA quantiles reported by a sketch:\n");
+  printf("  - median: %f\tp90: %f\n", gpa_sketch_quantile(sketch, 0.5),
+    gpa_sketch_quantile(sketch, 0.9));
+  gpa_sketch_free(sketch);
+
+  /*
+   * Build the first and second halves of the testing students with
+   * create_student_array_with_sketch(), each with its own sketch, and merge
+   * the sketches with gpa_sketch_merge().  The merged sketch summarizes every
+   * student, so it reports the same quantiles as the sketch above.
+   */
+  int half = NUM_TESTING_STUDENTS / 2;
+  struct gpa_sketch* first = gpa_sketch_create(GPA_SKETCH_DEFAULT_K);
+  struct gpa_sketch* second = gpa_sketch_create(GPA_SKETCH_DEFAULT_K);
+  struct dynarray* first_half = create_student_array_with_sketch(half,
+    TESTING_NAMES, TESTING_IDS, TESTING_GPAS, first);
+  struct dynarray* second_half = create_student_array_with_sketch(
+    NUM_TESTING_STUDENTS - half, TESTING_NAMES + half, TESTING_IDS + half,
+    TESTING_GPAS + half, second);
+  gpa_sketch_merge(first, second);
+  printf("\n== Here are the GPA quantiles reported by two merged sketches:\n");
+  printf("  - count: %lld\tmedian: %f\tp90: %f\n", gpa_sketch_count(first),
+    gpa_sketch_quantile(first, 0.5), gpa_sketch_quantile(first, 0.9));
+  free_student_array(second_half);
+  free_student_array(first_half);
+  gpa_sketch_free(second);
+  gpa_sketch_free(first);
+
+  /*
+   * Merge two sketches that have each compacted many GPAs evenly spread over
+   * [0, 4] and check that the merged median is close to the true one.
+   */
+  first = gpa_sketch_create(GPA_SKETCH_DEFAULT_K);
+  second = gpa_sketch_create(GPA_SKETCH_DEFAULT_K);
+  for (i = 0; i < 200000; i++) {
+    gpa_sketch_add(i < 100000 ? first : second, (i * 7919 % 4001) / 1000.0);
+  }
+  gpa_sketch_merge(first, second);
+  float merged_median = gpa_sketch_quantile(first, 0.5);
+  printf("  - count: %lld\tmedian within 0.05 of 2.0: %s\n",
+    gpa_sketch_count(first),
+    merged_median > 1.95 && merged_median < 2.05 ? "yes" : "no");
+  gpa_sketch_free(second);
+  gpa_sketch_free(first);
+
+  /*
+   * Join the students against updated GPAs for the three students with the
+   * highest GPAs and print each matching pair.
+   */
+  struct dynarray* updates = dynarray_create();
+  selected = top_k_by_gpa(students, 3);
+  for (i = 0; i < dynarray_size(selected); i++) {
+    s = dynarray_get(selected, i);
+    dynarray_insert(updates, -1, create_student(s->name, s->id, 4.0));
+  }
+  dynarray_free(selected);
+  printf("\n== Here are the students joined with their updated GPAs:\n");
+  join_students_by_id(students, updates, print_joined_students, NULL);
+  free_student_array(updates);
+
+  /*
+   * Join arrays large enough for join_students_by_id() to partition them,
+   * and check the matching pairs against lookups in a student index.  The
+   * sizes are chosen so that students with the same ID have different GPAs
+   * in the two arrays, which makes the checksum catch swapped pairs.
+   */
+  struct dynarray* join_a = create_many_students(NUM_JOIN_STUDENTS);
+  struct dynarray* join_b = create_many_students(2 * NUM_JOIN_STUDENTS + 2);
+  long long joined = 0, expected = 0;
+  long long num_joined = join_students_by_id(join_a, join_b,
+    sum_joined_students, &joined);
+  long long num_expected = 0;
+  index = student_index_build(join_b);
+  for (i = 0; i < NUM_JOIN_STUDENTS; i++) {
+    s = dynarray_get(join_a, i);
+    struct student* match = student_index_lookup(index, s->id);
+    if (match) {
+      sum_joined_students(s, match, &expected);
+      num_expected++;
+    }
+  }
+  student_index_free(index);
+  printf("\n== Here are the results of a partitioned join of %d and %d students:\n",
+    NUM_JOIN_STUDENTS, 2 * NUM_JOIN_STUDENTS + 2);
+  printf("  - matches: %lld\tsame pairs as index lookups: %s\n", num_joined,
+    num_joined == num_expected && joined == expected ? "yes" : "no");
+  free_student_array(join_b);
+  free_student_array(join_a);
+
+  /*
+   * Build the same array of students with create_student_array_parallel()
+   * and print it.
+   */
+  struct dynarray* parallel = create_student_array_parallel(
+    NUM_TESTING_STUDENTS, TESTING_NAMES, TESTING_IDS, TESTING_GPAS, 0);
+  printf("\n== Here are the results of create_student_array_parallel():\n");
+  print_students(parallel);
+  free_student_array(parallel);
+
+  /*
+   * Build an array large enough to be split between several threads, and
+   * compare it with the one built by create_student_array().
+   */
+  char** ingest_names = malloc(NUM_INGEST_STUDENTS * sizeof(char*));
+  int* ingest_ids = malloc(NUM_INGEST_STUDENTS * sizeof(int));
+  float* ingest_gpas = malloc(NUM_INGEST_STUDENTS * sizeof(float));
+  for (i = 0; i < NUM_INGEST_STUDENTS; i++) {
+    ingest_names[i] = TESTING_NAMES[i % NUM_TESTING_STUDENTS];
+    ingest_ids[i] = i * 7 % NUM_INGEST_STUDENTS;
+    ingest_gpas[i] = (i % 401) / 100.0;
+  }
+  struct dynarray* serial = create_student_array(NUM_INGEST_STUDENTS,
+    ingest_names, ingest_ids, ingest_gpas);
+  parallel = create_student_array_parallel(NUM_INGEST_STUDENTS, ingest_names,
+    ingest_ids, ingest_gpas, 4);
+  printf("  - %d students built with 4 threads match: %s\n",
+    NUM_INGEST_STUDENTS, same_students(serial, parallel) ? "yes" : "no");
+  free_student_array(parallel);
+  free_student_array(serial);
+  free(ingest_gpas);
+  free(ingest_ids);
+  free(ingest_names);
+
+  /*
+   * Allocate students on several threads, then free them on other threads
+   * while allocating new ones.  The threads exit after each round, which
+   * hands their cached objects back to the pool.  If any object were handed
+   * out twice, some student would have been overwritten.
+   */
+  struct student** pool_students[2 * NUM_POOL_THREADS];
+  struct pool_job pool_jobs[NUM_POOL_THREADS];
+  for (i = 0; i < 2 * NUM_POOL_THREADS; i++) {
+    pool_students[i] = malloc(NUM_POOL_STUDENTS * sizeof(struct student*));
+  }
+  for (i = 0; i < NUM_POOL_THREADS; i++) {
+    pool_jobs[i].release = NULL;
+    pool_jobs[i].create = pool_students[i];
+    pool_jobs[i].first_id = i * NUM_POOL_STUDENTS;
+  }
+  run_workers(pool_jobs, sizeof(struct pool_job), NUM_POOL_THREADS,
+    run_pool_job);
+  for (i = 0; i < NUM_POOL_THREADS; i++) {
+    pool_jobs[i].release = pool_students[(i + 1) % NUM_POOL_THREADS];
+    pool_jobs[i].create = pool_students[NUM_POOL_THREADS + i];
+    pool_jobs[i].first_id = (NUM_POOL_THREADS + i) * NUM_POOL_STUDENTS;
+  }
+  run_workers(pool_jobs, sizeof(struct pool_job), NUM_POOL_THREADS,
+    run_pool_job);
+
+  int pool_intact = 1;
+  for (i = NUM_POOL_THREADS; i < 2 * NUM_POOL_THREADS; i++) {
+    for (int j = 0; j < NUM_POOL_STUDENTS; j++) {
+      struct student* student = pool_students[i][j];
+      pool_intact &= student->id == i * NUM_POOL_STUDENTS + j &&
+        student->gpa == j &&
+        student->name == TESTING_NAMES[j % NUM_TESTING_STUDENTS];
+      free_student(student);
+    }
+  }
+  for (i = 0; i < 2 * NUM_POOL_THREADS; i++) {
+    free(pool_students[i]);
+  }
+  printf("\n== Here's whether students allocated and released by %d threads are intact:\n",
+    NUM_POOL_THREADS);
+  printf("  - %s\n", pool_intact ? "yes" : "no");
+
   /*
    * Free the memory we allocated to the array.  You should use valgrind to
    * verify that you don't have memory leaks.
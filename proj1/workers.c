@@ -0,0 +1,64 @@
+/*
+ * This file contains the definition of a function running a batch of jobs on
+ * several threads.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "workers.h"
+
+/*
+ * This is the bookkeeping for one job.  started is nonzero if the job got a
+ * thread of its own.
+ */
+struct worker {
+  pthread_t thread;
+  int started;
+  void* job;
+  worker_fn run;
+};
+
+
+/*
+ * Thread entry point running one job.
+ */
+static void* _worker_start(void* arg) {
+  struct worker* worker = arg;
+  worker->run(worker->job);
+  return NULL;
+}
+
+
+void run_workers(void* jobs, size_t job_size, int num_jobs, worker_fn run) {
+  assert(jobs && num_jobs > 0 && run);
+
+  struct worker* workers = malloc(num_jobs * sizeof(struct worker));
+  assert(workers);
+
+  for (int t = 1; t < num_jobs; t++) {
+    workers[t].job = (char*)jobs + t * job_size;
+    workers[t].run = run;
+    workers[t].started = pthread_create(&workers[t].thread, NULL,
+      _worker_start, &workers[t]) == 0;
+    if (!workers[t].started) {
+      /*
+       * The thread couldn't be created, so run its job here instead.
+       */
+      run(workers[t].job);
+    }
+  }
+  run(jobs);
+
+  /*
+   * Joining the threads publishes the stores made by their jobs.
+   */
+  for (int t = 1; t < num_jobs; t++) {
+    if (workers[t].started) {
+      pthread_join(workers[t].thread, NULL);
+    }
+  }
+
+  free(workers);
+}
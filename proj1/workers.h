@@ -0,0 +1,31 @@
+/*
+ * This file contains the definition of an interface for running a batch of
+ * jobs on several threads.
+ */
+
+#ifndef __WORKERS_H
+#define __WORKERS_H
+
+#include <stddef.h>
+
+/*
+ * The type of the function running one job.  It is passed a pointer to the
+ * job's description.
+ */
+typedef void (*worker_fn)(void* job);
+
+/*
+ * Runs num_jobs jobs in parallel and returns once all of them are done.  The
+ * calling thread runs job 0, so a single job never creates a thread.  A job
+ * whose thread can't be created is run by the calling thread instead.  Every
+ * store made by a job is visible to the caller once this function returns.
+ *
+ * Params:
+ *   jobs - an array of num_jobs job descriptions.  May not be NULL.
+ *   job_size - the size in bytes of each job description.
+ *   num_jobs - the number of jobs.  Must be greater than 0.
+ *   run - the function running one job.  May not be NULL.
+ */
+void run_workers(void* jobs, size_t job_size, int num_jobs, worker_fn run);
+
+#endif
@@ -0,0 +1,199 @@
+/*
+ * This file contains a small benchmark of the queue implementations.  For
+ * each queue depth, it fills a queue to that depth and then times a long run
+ * of enqueue/dequeue pairs, so the queue stays at the same depth throughout.
+ * With amortized constant-time operations, the time per operation shouldn't
+ * grow with the depth.
+ *
+ * It then times moving values through a queue and a stack one at a time and
+ * in batches of BENCH_BATCH.
+ *
+ * It also compares the stack-from-queues strategies on a push-heavy and a
+ * pop-heavy workload by the number of values each one moves per operation.
+ *
+ * Build and run it with `make bench && ./bench`.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "stack.h"
+#include "queue.h"
+#include "queue_from_stacks.h"
+#include "stack_from_queues.h"
+
+/*
+ * The number of enqueue/dequeue pairs timed at each depth.
+ */
+#define BENCH_OPS 1000000
+
+/*
+ * The batch size used to time the batch operations.
+ */
+#define BENCH_BATCH 256
+
+/*
+ * Auxilliary function returning the current time in nanoseconds.
+ */
+static double now_ns() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/*
+ * Returns the average time in nanoseconds of one operation on a queue held
+ * at a given depth.  The checksum keeps the compiler from dropping the work.
+ */
+static double bench_queue(int depth, long long* checksum) {
+  struct queue* queue = queue_create();
+  for (int i = 0; i < depth; i++) {
+    queue_enqueue(queue, i);
+  }
+
+  double start = now_ns();
+  for (int i = 0; i < BENCH_OPS; i++) {
+    queue_enqueue(queue, i);
+    *checksum += queue_dequeue(queue);
+  }
+  double elapsed = now_ns() - start;
+
+  queue_free(queue);
+  return elapsed / (2.0 * BENCH_OPS);
+}
+
+
+static double bench_queue_from_stacks(int depth, long long* checksum) {
+  struct queue_from_stacks* queue = queue_from_stacks_create();
+  for (int i = 0; i < depth; i++) {
+    queue_from_stacks_enqueue(queue, i);
+  }
+
+  double start = now_ns();
+  for (int i = 0; i < BENCH_OPS; i++) {
+    queue_from_stacks_enqueue(queue, i);
+    *checksum += queue_from_stacks_dequeue(queue);
+  }
+  double elapsed = now_ns() - start;
+
+  queue_from_stacks_free(queue);
+  return elapsed / (2.0 * BENCH_OPS);
+}
+
+
+/*
+ * Returns the average time in nanoseconds per value of moving BENCH_OPS
+ * values through a queue and a stack, one at a time if batch is 0 or in
+ * batches of BENCH_BATCH otherwise.
+ */
+static void bench_batches(int batch, double* queue_ns, double* stack_ns,
+    long long* checksum) {
+  int values[BENCH_BATCH], out[BENCH_BATCH];
+  for (int i = 0; i < BENCH_BATCH; i++) {
+    values[i] = i;
+  }
+
+  struct queue* queue = queue_create();
+  double start = now_ns();
+  for (int done = 0; done < BENCH_OPS; done += BENCH_BATCH) {
+    if (batch) {
+      queue_enqueue_n(queue, values, BENCH_BATCH);
+      *checksum += queue_dequeue_n(queue, out, BENCH_BATCH) + out[0];
+    } else {
+      for (int i = 0; i < BENCH_BATCH; i++) {
+        queue_enqueue(queue, values[i]);
+      }
+      for (int i = 0; i < BENCH_BATCH; i++) {
+        *checksum += queue_dequeue(queue);
+      }
+    }
+  }
+  *queue_ns = (now_ns() - start) / BENCH_OPS;
+  queue_free(queue);
+
+  struct stack* stack = stack_create();
+  start = now_ns();
+  for (int done = 0; done < BENCH_OPS; done += BENCH_BATCH) {
+    if (batch) {
+      stack_push_n(stack, values, BENCH_BATCH);
+      *checksum += stack_pop_n(stack, out, BENCH_BATCH) + out[0];
+    } else {
+      for (int i = 0; i < BENCH_BATCH; i++) {
+        stack_push(stack, values[i]);
+      }
+      for (int i = 0; i < BENCH_BATCH; i++) {
+        *checksum += stack_pop(stack);
+      }
+    }
+  }
+  *stack_ns = (now_ns() - start) / BENCH_OPS;
+  stack_free(stack);
+}
+
+
+/*
+ * Returns the average number of moves per operation a stack-from-queues with
+ * a given strategy takes on a workload of rounds rounds, each made up of
+ * pushes pushes followed by pops pops.  The stack is first filled with
+ * depth values.  Filling counts too, since the pop-cheap layout pays for
+ * its cheap pops while it is being filled.
+ */
+static double bench_stack_from_queues(enum stack_from_queues_mode mode,
+    int depth, int rounds, int pushes, int pops) {
+  struct stack_from_queues* stack = stack_from_queues_create_mode(mode);
+  for (int i = 0; i < depth; i++) {
+    stack_from_queues_push(stack, i);
+  }
+
+  for (int r = 0; r < rounds; r++) {
+    for (int i = 0; i < pushes; i++) {
+      stack_from_queues_push(stack, i);
+    }
+    for (int i = 0; i < pops; i++) {
+      stack_from_queues_pop(stack);
+    }
+  }
+  long long moves = stack_from_queues_moves(stack);
+
+  stack_from_queues_free(stack);
+  return (double)moves / (depth + rounds * (pushes + pops));
+}
+
+
+int main(int argc, char** argv) {
+  int depths[] = { 10, 1000, 100000 };
+  int num_depths = sizeof(depths) / sizeof(depths[0]);
+  long long checksum = 0;
+
+  printf("Time per operation (ns):\n");
+  printf("%-10s %18s %18s\n", "depth", "queue", "queue_from_stacks");
+  for (int d = 0; d < num_depths; d++) {
+    double q = bench_queue(depths[d], &checksum);
+    double qfs = bench_queue_from_stacks(depths[d], &checksum);
+    printf("%-10d %18.1f %18.1f\n", depths[d], q, qfs);
+  }
+
+  printf("\nTime per value moved through in and out (ns):\n");
+  printf("%-10s %18s %18s\n", "batch", "queue", "stack");
+  for (int batch = 0; batch <= 1; batch++) {
+    double q, s;
+    bench_batches(batch, &q, &s, &checksum);
+    printf("%-10d %18.1f %18.1f\n", batch ? BENCH_BATCH : 1, q, s);
+  }
+  printf("(checksum %lld)\n", checksum);
+
+  const char* mode_names[] = { "push-cheap", "pop-cheap", "adaptive" };
+  printf("\nStack-from-queues moves per operation, filling to depth 1000 included:\n");
+  printf("%-12s %18s %18s\n", "mode", "10 push/1 pop", "1 push/10 pop");
+  for (int m = 0; m < 3; m++) {
+    double push_heavy = bench_stack_from_queues(m, 1000, 100, 10, 1);
+    double pop_heavy = bench_stack_from_queues(m, 1000, 90, 1, 10);
+    printf("%-12s %18.1f %18.1f\n", mode_names[m], push_heavy, pop_heavy);
+  }
+
+  return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a pool of nodes for the lock-free containers.
+ *
+ * Nodes live in chunks of geometrically increasing size: chunk 0 holds the
+ * first LFPOOL_BASE nodes, chunk 1 the next 2 * LFPOOL_BASE, and so on, so a
+ * small, fixed directory of chunks covers every 32-bit index.  Chunks are
+ * allocated on demand and never moved or freed while the pool exists.
+ * Released nodes are kept on a Treiber stack threaded through their next
+ * links.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "lfpool.h"
+
+#define LFPOOL_BASE_BITS 6
+#define LFPOOL_BASE (1u << LFPOOL_BASE_BITS)
+#define LFPOOL_NUM_CHUNKS (33 - LFPOOL_BASE_BITS)
+
+/*
+ * This is the definition of the pool structure.  free_top is the tagged
+ * index of the top released node, and next_fresh the index of the first
+ * node that has never been handed out.
+ */
+struct lfpool {
+  _Atomic(struct lfnode*) chunks[LFPOOL_NUM_CHUNKS];
+  _Atomic uint64_t free_top;
+  _Atomic uint32_t next_fresh;
+};
+
+
+/*
+ * Auxilliary function to find the chunk holding a node and the node's offset
+ * within it.
+ */
+static int _lfpool_locate(uint32_t index, uint64_t* offset) {
+  uint64_t pos = (uint64_t)index + LFPOOL_BASE;
+  int chunk = 63 - __builtin_clzll(pos) - LFPOOL_BASE_BITS;
+  *offset = pos - ((uint64_t)LFPOOL_BASE << chunk);
+  return chunk;
+}
+
+
+struct lfpool* lfpool_create() {
+  struct lfpool* pool = malloc(sizeof(struct lfpool));
+  assert(pool);
+  for (int c = 0; c < LFPOOL_NUM_CHUNKS; c++) {
+    atomic_init(&pool->chunks[c], NULL);
+  }
+  atomic_init(&pool->free_top, lf_pack(0, LF_NULL));
+  atomic_init(&pool->next_fresh, 0);
+  return pool;
+}
+
+
+void lfpool_free(struct lfpool* pool) {
+  assert(pool);
+  for (int c = 0; c < LFPOOL_NUM_CHUNKS; c++) {
+    free(atomic_load(&pool->chunks[c]));
+  }
+  free(pool);
+}
+
+
+uint32_t lfpool_alloc(struct lfpool* pool) {
+  assert(pool);
+
+  /*
+   * Pop a released node if there is one.  Reading the next link of a node
+   * that another thread has just popped is safe because nodes are never
+   * freed, and the tag makes our CAS fail in that case.
+   */
+  uint64_t top = atomic_load(&pool->free_top);
+  while (lf_index(top) != LF_NULL) {
+    struct lfnode* node = lfpool_node(pool, lf_index(top));
+    uint64_t next = atomic_load(&node->next);
+    if (atomic_compare_exchange_weak(&pool->free_top, &top,
+        lf_pack(lf_tag(top) + 1, lf_index(next)))) {
+      return lf_index(top);
+    }
+  }
+
+  /*
+   * Otherwise, hand out a fresh node, allocating its chunk if this is the
+   * first node in it.  If two threads race to allocate the same chunk, the
+   * loser frees its copy.
+   */
+  uint32_t index = atomic_fetch_add(&pool->next_fresh, 1);
+  assert(index != LF_NULL);
+  uint64_t offset;
+  int c = _lfpool_locate(index, &offset);
+  if (!atomic_load(&pool->chunks[c])) {
+    size_t size = (size_t)LFPOOL_BASE << c;
+    struct lfnode* chunk = calloc(size, sizeof(struct lfnode));
+    assert(chunk);
+    for (size_t i = 0; i < size; i++) {
+      atomic_init(&chunk[i].next, lf_pack(0, LF_NULL));
+      atomic_init(&chunk[i].value, 0);
+    }
+    struct lfnode* expected = NULL;
+    if (!atomic_compare_exchange_strong(&pool->chunks[c], &expected, chunk)) {
+      free(chunk);
+    }
+  }
+  return index;
+}
+
+
+void lfpool_release(struct lfpool* pool, uint32_t index) {
+  assert(pool && index != LF_NULL);
+  struct lfnode* node = lfpool_node(pool, index);
+
+  /*
+   * The node's own next link keeps counting up across reuse, which the
+   * lock-free queue relies on.
+   */
+  uint64_t top = atomic_load(&pool->free_top);
+  do {
+    uint64_t next = atomic_load(&node->next);
+    atomic_store(&node->next, lf_pack(lf_tag(next) + 1, lf_index(top)));
+  } while (!atomic_compare_exchange_weak(&pool->free_top, &top,
+      lf_pack(lf_tag(top) + 1, index)));
+}
+
+
+struct lfnode* lfpool_node(struct lfpool* pool, uint32_t index) {
+  uint64_t offset;
+  int c = _lfpool_locate(index, &offset);
+  return atomic_load(&pool->chunks[c]) + offset;
+}
@@ -0,0 +1,97 @@
+/*
+ * This file contains the definition of an interface for a pool of nodes
+ * shared by the lock-free containers.  Nodes are named by 32-bit indices
+ * instead of pointers, and the memory behind an index is never freed until
+ * the whole pool is.  A thread can therefore always safely read a node it
+ * has an index for, even if another thread has meanwhile removed the node
+ * and given it back to the pool.
+ *
+ * Links between nodes are "tagged indices": 64-bit words holding a node
+ * index in the low 32 bits and a modification counter in the high 32 bits.
+ * Every successful compare-and-swap of a tagged index bumps the counter, so
+ * a CAS based on a stale read fails even if the same node index has come
+ * back in the meantime (the ABA problem).
+ */
+
+#ifndef __LFPOOL_H
+#define __LFPOOL_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*
+ * The index used as a null link.
+ */
+#define LF_NULL UINT32_MAX
+
+/*
+ * This is a node.  next is a tagged index, and value is atomic because a
+ * reader may look at it while another thread reuses the node.
+ */
+struct lfnode {
+  _Atomic uint64_t next;
+  _Atomic int value;
+};
+
+/*
+ * Structure used to represent a pool of nodes.
+ */
+struct lfpool;
+
+/*
+ * Helpers to build and take apart tagged indices.
+ */
+static inline uint64_t lf_pack(uint32_t tag, uint32_t index) {
+  return ((uint64_t)tag << 32) | index;
+}
+
+static inline uint32_t lf_index(uint64_t tagged) {
+  return (uint32_t)tagged;
+}
+
+static inline uint32_t lf_tag(uint64_t tagged) {
+  return (uint32_t)(tagged >> 32);
+}
+
+/*
+ * Creates a new, empty pool and returns a pointer to it.
+ */
+struct lfpool* lfpool_create();
+
+/*
+ * Free all of the memory associated with a pool, including every node.  No
+ * other thread may be using the pool.
+ *
+ * Params:
+ *   pool - the pool to be destroyed.  May not be NULL.
+ */
+void lfpool_free(struct lfpool* pool);
+
+/*
+ * Takes a node from a pool, reusing a released node if there is one.  Safe
+ * to call from several threads at once.
+ *
+ * Params:
+ *   pool - the pool from which to take a node.  May not be NULL.
+ *
+ * Return:
+ *   Returns the index of the node.
+ */
+uint32_t lfpool_alloc(struct lfpool* pool);
+
+/*
+ * Gives a node back to a pool.  Safe to call from several threads at once.
+ *
+ * Params:
+ *   pool - the pool the node was taken from.  May not be NULL.
+ *   index - the index of the node.
+ */
+void lfpool_release(struct lfpool* pool, uint32_t index);
+
+/*
+ * Returns a pointer to the node with a given index, which must have been
+ * returned by lfpool_alloc() at some point.
+ */
+struct lfnode* lfpool_node(struct lfpool* pool, uint32_t index);
+
+#endif
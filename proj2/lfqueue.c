@@ -0,0 +1,167 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a lock-free queue, using the algorithm of Michael and Scott.  The queue is
+ * a linked list that always starts with a dummy node; the front value lives
+ * in the node after it.  Enqueuers link a node after the last one and then
+ * swing the tail, and any thread that finds the tail lagging behind helps
+ * swing it.  Dequeuers swing the head forward, making the first value's
+ * node the new dummy.
+ *
+ * Nodes come from an lfpool.  The head, the tail, and every node's next link
+ * are tagged indices, and a node's next link keeps counting up when the node
+ * is reused, so no CAS can succeed based on a stale read.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "lfpool.h"
+#include "lfqueue.h"
+
+/*
+ * This is the definition of the lock-free queue structure.  head is the
+ * tagged index of the dummy node and tail that of the last node (or, for a
+ * moment, the one before it).  They are kept on separate cache lines so that
+ * enqueuers and dequeuers don't contend for one.
+ */
+struct lfqueue {
+  _Alignas(64) _Atomic uint64_t head;
+  _Alignas(64) _Atomic uint64_t tail;
+  _Alignas(64) struct lfpool* pool;
+};
+
+
+/*
+ * Auxilliary function to take a node from the pool and make it the end of a
+ * list.
+ */
+static uint32_t _lfqueue_new_node(struct lfqueue* queue, int value) {
+  uint32_t index = lfpool_alloc(queue->pool);
+  struct lfnode* node = lfpool_node(queue->pool, index);
+  atomic_store_explicit(&node->value, value, memory_order_relaxed);
+  uint64_t next = atomic_load(&node->next);
+  atomic_store(&node->next, lf_pack(lf_tag(next) + 1, LF_NULL));
+  return index;
+}
+
+
+struct lfqueue* lfqueue_create() {
+  struct lfqueue* queue = aligned_alloc(64, sizeof(struct lfqueue));
+  assert(queue);
+  queue->pool = lfpool_create();
+  uint32_t dummy = _lfqueue_new_node(queue, 0);
+  atomic_init(&queue->head, lf_pack(0, dummy));
+  atomic_init(&queue->tail, lf_pack(0, dummy));
+  return queue;
+}
+
+
+void lfqueue_free(struct lfqueue* queue) {
+  assert(queue);
+  lfpool_free(queue->pool);
+  free(queue);
+}
+
+
+int lfqueue_isempty(struct lfqueue* queue) {
+  assert(queue);
+  uint64_t head = atomic_load(&queue->head);
+  struct lfnode* dummy = lfpool_node(queue->pool, lf_index(head));
+  return lf_index(atomic_load(&dummy->next)) == LF_NULL;
+}
+
+
+void lfqueue_enqueue(struct lfqueue* queue, int value) {
+  assert(queue);
+  uint32_t index = _lfqueue_new_node(queue, value);
+
+  uint64_t tail;
+  for (;;) {
+    tail = atomic_load(&queue->tail);
+    struct lfnode* last = lfpool_node(queue->pool, lf_index(tail));
+    uint64_t next = atomic_load(&last->next);
+    if (tail != atomic_load(&queue->tail)) {
+      continue;
+    }
+
+    if (lf_index(next) == LF_NULL) {
+      if (atomic_compare_exchange_weak(&last->next, &next,
+          lf_pack(lf_tag(next) + 1, index))) {
+        break;
+      }
+    } else {
+      /*
+       * The tail is lagging behind; help move it along before retrying.
+       */
+      atomic_compare_exchange_strong(&queue->tail, &tail,
+        lf_pack(lf_tag(tail) + 1, lf_index(next)));
+    }
+  }
+
+  /*
+   * Swing the tail to the new node.  If this fails, another thread already
+   * did it for us.
+   */
+  atomic_compare_exchange_strong(&queue->tail, &tail,
+    lf_pack(lf_tag(tail) + 1, index));
+}
+
+
+int lfqueue_front(struct lfqueue* queue, int* value) {
+  assert(queue && value);
+  for (;;) {
+    uint64_t head = atomic_load(&queue->head);
+    struct lfnode* dummy = lfpool_node(queue->pool, lf_index(head));
+    uint64_t next = atomic_load(&dummy->next);
+    if (lf_index(next) == LF_NULL) {
+      if (head == atomic_load(&queue->head)) {
+        return 0;
+      }
+      continue;
+    }
+
+    /*
+     * The value only counts if the head hasn't moved since we read it.
+     */
+    int v = atomic_load(&lfpool_node(queue->pool, lf_index(next))->value);
+    if (head == atomic_load(&queue->head)) {
+      *value = v;
+      return 1;
+    }
+  }
+}
+
+
+int lfqueue_dequeue(struct lfqueue* queue, int* value) {
+  assert(queue && value);
+  for (;;) {
+    uint64_t head = atomic_load(&queue->head);
+    uint64_t tail = atomic_load(&queue->tail);
+    struct lfnode* dummy = lfpool_node(queue->pool, lf_index(head));
+    uint64_t next = atomic_load(&dummy->next);
+    if (head != atomic_load(&queue->head)) {
+      continue;
+    }
+
+    if (lf_index(head) == lf_index(tail)) {
+      if (lf_index(next) == LF_NULL) {
+        return 0;
+      }
+      atomic_compare_exchange_strong(&queue->tail, &tail,
+        lf_pack(lf_tag(tail) + 1, lf_index(next)));
+      continue;
+    }
+
+    /*
+     * Read the value before swinging the head, since once the head moves
+     * another dequeuer may release the node holding it.
+     */
+    int v = atomic_load(&lfpool_node(queue->pool, lf_index(next))->value);
+    if (atomic_compare_exchange_weak(&queue->head, &head,
+        lf_pack(lf_tag(head) + 1, lf_index(next)))) {
+      lfpool_release(queue->pool, lf_index(head));
+      *value = v;
+      return 1;
+    }
+  }
+}
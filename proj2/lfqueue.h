@@ -0,0 +1,70 @@
+/*
+ * This file contains the definition of an interface for a lock-free queue
+ * that any number of threads can enqueue into and dequeue from at once.
+ */
+
+#ifndef __LFQUEUE_H
+#define __LFQUEUE_H
+
+/*
+ * Structure used to represent a lock-free queue.
+ */
+struct lfqueue;
+
+/*
+ * Creates a new, empty lock-free queue and returns a pointer to it.
+ */
+struct lfqueue* lfqueue_create();
+
+/*
+ * Free all of the memory associated with a lock-free queue.  No other thread
+ * may be using the queue.
+ *
+ * Params:
+ *   queue - the queue to be destroyed.  May not be NULL.
+ */
+void lfqueue_free(struct lfqueue* queue);
+
+/*
+ * Returns 1 if the given queue is empty or 0 otherwise.  When other threads
+ * are using the queue, the answer may be out of date by the time it returns.
+ *
+ * Params:
+ *   queue - the queue whose emptiness is to be checked.  May not be NULL.
+ */
+int lfqueue_isempty(struct lfqueue* queue);
+
+/*
+ * Enqueue a new value onto a lock-free queue.
+ *
+ * Params:
+ *   queue - the queue onto which to enqueue a value.  May not be NULL.
+ *   value - the new value to be enqueued onto the queue
+ */
+void lfqueue_enqueue(struct lfqueue* queue, int value);
+
+/*
+ * Reads a queue's front value without removing that value from the queue.
+ *
+ * Params:
+ *   queue - the queue from which to read the front value.  May not be NULL.
+ *   value - receives the front value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was read or 0 if the queue was empty.
+ */
+int lfqueue_front(struct lfqueue* queue, int* value);
+
+/*
+ * Removes the front element from a lock-free queue.
+ *
+ * Params:
+ *   queue - the queue from which to dequeue a value.  May not be NULL.
+ *   value - receives the dequeued value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was dequeued or 0 if the queue was empty.
+ */
+int lfqueue_dequeue(struct lfqueue* queue, int* value);
+
+#endif
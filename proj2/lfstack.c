@@ -0,0 +1,102 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a lock-free stack, using Treiber's algorithm: the stack is a linked list,
+ * and pushes and pops swing the top link with a compare-and-swap.  Nodes come
+ * from an lfpool, whose tagged indices protect the CAS against ABA.
+ */
+
+#include <stdlib.h>
+#include <assert.h>
+
+#include "lfpool.h"
+#include "lfstack.h"
+
+/*
+ * This is the definition of the lock-free stack structure.  top is the
+ * tagged index of the top node.
+ */
+struct lfstack {
+  _Atomic uint64_t top;
+  struct lfpool* pool;
+};
+
+
+struct lfstack* lfstack_create() {
+  struct lfstack* stack = malloc(sizeof(struct lfstack));
+  assert(stack);
+  atomic_init(&stack->top, lf_pack(0, LF_NULL));
+  stack->pool = lfpool_create();
+  return stack;
+}
+
+
+void lfstack_free(struct lfstack* stack) {
+  assert(stack);
+  lfpool_free(stack->pool);
+  free(stack);
+}
+
+
+int lfstack_isempty(struct lfstack* stack) {
+  assert(stack);
+  return lf_index(atomic_load(&stack->top)) == LF_NULL;
+}
+
+
+void lfstack_push(struct lfstack* stack, int value) {
+  assert(stack);
+  uint32_t index = lfpool_alloc(stack->pool);
+  struct lfnode* node = lfpool_node(stack->pool, index);
+  atomic_store_explicit(&node->value, value, memory_order_relaxed);
+
+  uint64_t top = atomic_load(&stack->top);
+  do {
+    uint64_t next = atomic_load(&node->next);
+    atomic_store(&node->next, lf_pack(lf_tag(next) + 1, lf_index(top)));
+  } while (!atomic_compare_exchange_weak(&stack->top, &top,
+      lf_pack(lf_tag(top) + 1, index)));
+}
+
+
+int lfstack_top(struct lfstack* stack, int* value) {
+  assert(stack && value);
+
+  /*
+   * The top node may be popped and reused while we read it, so the value
+   * only counts if the top hasn't changed since (any change bumps the tag).
+   */
+  uint64_t top = atomic_load(&stack->top);
+  for (;;) {
+    if (lf_index(top) == LF_NULL) {
+      return 0;
+    }
+    struct lfnode* node = lfpool_node(stack->pool, lf_index(top));
+    int v = atomic_load(&node->value);
+    uint64_t again = atomic_load(&stack->top);
+    if (again == top) {
+      *value = v;
+      return 1;
+    }
+    top = again;
+  }
+}
+
+
+int lfstack_pop(struct lfstack* stack, int* value) {
+  assert(stack && value);
+
+  uint64_t top = atomic_load(&stack->top);
+  for (;;) {
+    if (lf_index(top) == LF_NULL) {
+      return 0;
+    }
+    struct lfnode* node = lfpool_node(stack->pool, lf_index(top));
+    uint64_t next = atomic_load(&node->next);
+    if (atomic_compare_exchange_weak(&stack->top, &top,
+        lf_pack(lf_tag(top) + 1, lf_index(next)))) {
+      *value = atomic_load_explicit(&node->value, memory_order_relaxed);
+      lfpool_release(stack->pool, lf_index(top));
+      return 1;
+    }
+  }
+}
@@ -0,0 +1,72 @@
+/*
+ * This file contains the definition of an interface for a lock-free stack
+ * that can be shared by several threads without any locking.
+ */
+
+#ifndef __LFSTACK_H
+#define __LFSTACK_H
+
+/*
+ * Structure used to represent a lock-free stack.
+ */
+struct lfstack;
+
+/*
+ * Creates a new, empty lock-free stack and returns a pointer to it.
+ */
+struct lfstack* lfstack_create();
+
+/*
+ * Free all of the memory associated with a lock-free stack.  No other thread
+ * may be using the stack.
+ *
+ * Params:
+ *   stack - the stack to be destroyed.  May not be NULL.
+ */
+void lfstack_free(struct lfstack* stack);
+
+/*
+ * Returns 1 if the given stack is empty or 0 otherwise.  When other threads
+ * are using the stack, the answer may be out of date by the time it returns.
+ *
+ * Params:
+ *   stack - the stack whose emptiness is to be checked.  May not be NULL.
+ */
+int lfstack_isempty(struct lfstack* stack);
+
+/*
+ * Push a new value onto a lock-free stack.
+ *
+ * Params:
+ *   stack - the stack onto which to push a value.  May not be NULL.
+ *   value - the new value to be pushed onto the stack
+ */
+void lfstack_push(struct lfstack* stack, int value);
+
+/*
+ * Reads a stack's top value without removing that value from the stack.
+ * Since another thread may empty the stack at any time, this doesn't require
+ * the stack to be non-empty; it reports whether there was a value instead.
+ *
+ * Params:
+ *   stack - the stack from which to read the top value.  May not be NULL.
+ *   value - receives the top value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was read or 0 if the stack was empty.
+ */
+int lfstack_top(struct lfstack* stack, int* value);
+
+/*
+ * Removes the top element from a lock-free stack.
+ *
+ * Params:
+ *   stack - the stack from which to pop a value.  May not be NULL.
+ *   value - receives the popped value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was popped or 0 if the stack was empty.
+ */
+int lfstack_pop(struct lfstack* stack, int* value);
+
+#endif
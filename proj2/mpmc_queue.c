@@ -0,0 +1,184 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a bounded multi-producer/multi-consumer queue, using Dmitry Vyukov's
+ * algorithm.
+ *
+ * Every slot of the ring has a sequence number saying whose turn it is.  The
+ * slot for the value with position pos is free for the producer of pos when
+ * its sequence number is pos, and holds a value for the consumer of pos when
+ * it is pos + 1; once consumed, it becomes pos + capacity, the position of
+ * the next value to use it.  Producers (and consumers) claim positions with
+ * a CAS on a shared counter, and then hand the slot over with a single
+ * release store of its sequence number, so threads only contend on the
+ * counter.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <assert.h>
+
+#include "mpmc_queue.h"
+
+#define MPMC_CACHE_LINE 64
+
+/*
+ * The number of failed attempts a blocking call makes before it starts
+ * giving up the processor between attempts.
+ */
+#define MPMC_SPIN_LIMIT 64
+
+/*
+ * This is a slot of the ring.
+ */
+struct mpmc_slot {
+  _Atomic size_t seq;
+  int value;
+};
+
+/*
+ * This is the definition of the queue structure.  The producers' counter,
+ * the consumers' counter, and the fields neither changes each get their own
+ * cache line.
+ */
+struct mpmc_queue {
+  _Alignas(MPMC_CACHE_LINE) _Atomic size_t enqueue_pos;
+  _Alignas(MPMC_CACHE_LINE) _Atomic size_t dequeue_pos;
+  _Alignas(MPMC_CACHE_LINE) struct mpmc_slot* slots;
+  size_t mask;
+};
+
+
+/*
+ * Auxilliary function to wait between attempts of a blocking call.
+ */
+static void _mpmc_backoff(int* attempts) {
+  if (++*attempts > MPMC_SPIN_LIMIT) {
+    sched_yield();
+  }
+}
+
+
+struct mpmc_queue* mpmc_queue_create(int capacity) {
+  assert(capacity > 0);
+  size_t size = 2;
+  while (size < (size_t)capacity) {
+    size *= 2;
+  }
+
+  struct mpmc_queue* queue =
+    aligned_alloc(MPMC_CACHE_LINE, sizeof(struct mpmc_queue));
+  assert(queue);
+  queue->slots = malloc(size * sizeof(struct mpmc_slot));
+  assert(queue->slots);
+  for (size_t i = 0; i < size; i++) {
+    atomic_init(&queue->slots[i].seq, i);
+  }
+  queue->mask = size - 1;
+  atomic_init(&queue->enqueue_pos, 0);
+  atomic_init(&queue->dequeue_pos, 0);
+  return queue;
+}
+
+
+void mpmc_queue_free(struct mpmc_queue* queue) {
+  assert(queue);
+  free(queue->slots);
+  free(queue);
+}
+
+
+int mpmc_queue_isempty(struct mpmc_queue* queue) {
+  assert(queue);
+  size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  struct mpmc_slot* slot = &queue->slots[pos & queue->mask];
+  return atomic_load_explicit(&slot->seq, memory_order_acquire) != pos + 1;
+}
+
+
+int mpmc_queue_try_enqueue(struct mpmc_queue* queue, int value) {
+  assert(queue);
+  size_t pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+  struct mpmc_slot* slot;
+
+  for (;;) {
+    slot = &queue->slots[pos & queue->mask];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+    if (diff == 0) {
+      /*
+       * The slot is free for position pos; try to claim that position.  On
+       * failure, pos is updated to the current counter.
+       */
+      if (atomic_compare_exchange_weak_explicit(&queue->enqueue_pos, &pos,
+          pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      /*
+       * The slot still holds the value from one lap ago: the queue is full.
+       */
+      return 0;
+    } else {
+      pos = atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    }
+  }
+
+  slot->value = value;
+  atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+  return 1;
+}
+
+
+void mpmc_queue_enqueue(struct mpmc_queue* queue, int value) {
+  int attempts = 0;
+  while (!mpmc_queue_try_enqueue(queue, value)) {
+    _mpmc_backoff(&attempts);
+  }
+}
+
+
+int mpmc_queue_try_dequeue(struct mpmc_queue* queue, int* value) {
+  assert(queue && value);
+  size_t pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+  struct mpmc_slot* slot;
+
+  for (;;) {
+    slot = &queue->slots[pos & queue->mask];
+    size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+    intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(&queue->dequeue_pos, &pos,
+          pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      /*
+       * The value for position pos hasn't been enqueued: the queue is empty.
+       */
+      return 0;
+    } else {
+      pos = atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    }
+  }
+
+  *value = slot->value;
+  atomic_store_explicit(&slot->seq, pos + queue->mask + 1,
+    memory_order_release);
+  return 1;
+}
+
+
+int mpmc_queue_dequeue(struct mpmc_queue* queue) {
+  int value, attempts = 0;
+  while (!mpmc_queue_try_dequeue(queue, &value)) {
+    _mpmc_backoff(&attempts);
+  }
+  return value;
+}
@@ -0,0 +1,89 @@
+/*
+ * This file contains the definition of an interface for a bounded queue that
+ * any number of threads can enqueue into and dequeue from at once.  Its
+ * memory is allocated once, when it is created.  A full queue pushes back
+ * on producers, either by refusing new values or by making them wait.
+ */
+
+#ifndef __MPMC_QUEUE_H
+#define __MPMC_QUEUE_H
+
+/*
+ * Structure used to represent a bounded multi-producer/multi-consumer queue.
+ */
+struct mpmc_queue;
+
+/*
+ * Creates a new, empty queue and returns a pointer to it.
+ *
+ * Params:
+ *   capacity - the largest number of values the queue must hold.  This is
+ *     rounded up to a power of 2 (and to at least 2).  Must be greater than
+ *     0.
+ */
+struct mpmc_queue* mpmc_queue_create(int capacity);
+
+/*
+ * Free all of the memory associated with a queue.  No other thread may be
+ * using the queue.
+ *
+ * Params:
+ *   queue - the queue to be destroyed.  May not be NULL.
+ */
+void mpmc_queue_free(struct mpmc_queue* queue);
+
+/*
+ * Returns 1 if the given queue is empty or 0 otherwise.  When other threads
+ * are using the queue, the answer may be out of date by the time it returns.
+ *
+ * Params:
+ *   queue - the queue whose emptiness is to be checked.  May not be NULL.
+ */
+int mpmc_queue_isempty(struct mpmc_queue* queue);
+
+/*
+ * Enqueues a new value onto a queue if there is room for it.
+ *
+ * Params:
+ *   queue - the queue onto which to enqueue a value.  May not be NULL.
+ *   value - the new value to be enqueued onto the queue
+ *
+ * Return:
+ *   Returns 1 if the value was enqueued or 0 if the queue was full.
+ */
+int mpmc_queue_try_enqueue(struct mpmc_queue* queue, int value);
+
+/*
+ * Enqueues a new value onto a queue, waiting for room if the queue is full.
+ *
+ * Params:
+ *   queue - the queue onto which to enqueue a value.  May not be NULL.
+ *   value - the new value to be enqueued onto the queue
+ */
+void mpmc_queue_enqueue(struct mpmc_queue* queue, int value);
+
+/*
+ * Removes the front element from a queue if there is one.
+ *
+ * Params:
+ *   queue - the queue from which to dequeue a value.  May not be NULL.
+ *   value - receives the dequeued value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was dequeued or 0 if the queue was empty.
+ */
+int mpmc_queue_try_dequeue(struct mpmc_queue* queue, int* value);
+
+/*
+ * Removes the front element from a queue and returns its value, waiting for
+ * a value if the queue is empty.
+ *
+ * Params:
+ *   queue - the queue from which to dequeue a value.  May not be NULL.
+ *
+ * Return:
+ *   Returns the dequeued value.
+ */
+int mpmc_queue_dequeue(struct mpmc_queue* queue);
+
+#endif
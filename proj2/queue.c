@@ -9,22 +9,86 @@
 #include "link.h"
 #include "queue.h"
 
+/*
+ * The number of dequeued links a queue keeps for reuse by default.  This can
+ * be overridden at compile time, e.g. with -DQUEUE_LINK_CACHE=0 to free every
+ * link right away.
+ */
+#ifndef QUEUE_LINK_CACHE
+#define QUEUE_LINK_CACHE 64
+#endif
+
 /*
  * This is the definition of the queue structure.  Using a linked list to
  * implement a queue requires that we keep track of both the head and the
- * tail of the queue.
+ * tail of the queue.  Dequeued links are kept in a free list (up to
+ * free_cap of them) so enqueueing can reuse them instead of allocating.
  */
 struct queue {
   struct link* head;
   struct link* tail;
+  struct link* free_links;
+  int free_count;
+  int free_cap;
 };
 
 
+/*
+ * Auxilliary function to get a link, reusing a free one if there is one.
+ */
+static struct link* _queue_get_link(struct queue* queue) {
+  struct link* link = queue->free_links;
+  if (link) {
+    queue->free_links = link->next;
+    queue->free_count--;
+  } else {
+    link = malloc(sizeof(struct link));
+    assert(link);
+  }
+  return link;
+}
+
+
+/*
+ * Auxilliary function to retire a link, keeping it for reuse if the free
+ * list isn't full.
+ */
+static void _queue_put_link(struct queue* queue, struct link* link) {
+  if (queue->free_count < queue->free_cap) {
+    link->next = queue->free_links;
+    queue->free_links = link;
+    queue->free_count++;
+  } else {
+    free(link);
+  }
+}
+
+
+/*
+ * Auxilliary function to allocate free links until there are at least n.
+ * The free list may then hold more than free_cap links until enough of them
+ * are used.  Links are allocated one at a time because each of them may
+ * later be freed on its own.
+ */
+static void _queue_stock_links(struct queue* queue, int n) {
+  while (queue->free_count < n) {
+    struct link* link = malloc(sizeof(struct link));
+    assert(link);
+    link->next = queue->free_links;
+    queue->free_links = link;
+    queue->free_count++;
+  }
+}
+
+
 struct queue* queue_create() {
   struct queue* queue = malloc(sizeof(struct queue));
   assert(queue);
   queue->head = NULL;
   queue->tail = NULL;
+  queue->free_links = NULL;
+  queue->free_count = 0;
+  queue->free_cap = QUEUE_LINK_CACHE;
   return queue;
 }
 
@@ -39,6 +103,11 @@ void queue_free(struct queue* queue) {
   while (!queue_isempty(queue)) {
     queue_dequeue(queue);
   }
+  while (queue->free_links) {
+    struct link* link = queue->free_links;
+    queue->free_links = link->next;
+    free(link);
+  }
   free(queue);
 }
 
@@ -51,8 +120,7 @@ int queue_isempty(struct queue* queue) {
 
 void queue_enqueue(struct queue* queue, int value) {
   assert(queue);
-  struct link* new_link = malloc(sizeof(struct link));
-  assert(new_link);
+  struct link* new_link = _queue_get_link(queue);
 
   /*
    * Fill out the new link at put it at the tail of the list, which represents
@@ -83,7 +151,7 @@ int queue_dequeue(struct queue* queue) {
 
   /*
    * Remove the old front element from the list and remember its value before
-   * we free it.
+   * we retire it.
    */
   struct link* dequeued_head = queue->head;
   int value = dequeued_head->value;
@@ -96,6 +164,62 @@ int queue_dequeue(struct queue* queue) {
     queue->tail = NULL;
   }
 
-  free(dequeued_head);
+  _queue_put_link(queue, dequeued_head);
   return value;
 }
+
+
+void queue_enqueue_n(struct queue* queue, const int* values, int n) {
+  assert(queue && n >= 0);
+  if (n == 0) {
+    return;
+  }
+
+  /*
+   * Chain the batch together, reusing free links before allocating new ones,
+   * then splice the whole chain onto the tail at once.  Unlike
+   * queue_reserve(), this doesn't raise free_cap, so the links go back to
+   * being freed once they are dequeued.
+   */
+  struct link* first = _queue_get_link(queue);
+  struct link* last = first;
+  first->value = values[0];
+  for (int i = 1; i < n; i++) {
+    last->next = _queue_get_link(queue);
+    last = last->next;
+    last->value = values[i];
+  }
+  last->next = NULL;
+
+  if (queue->tail) {
+    queue->tail->next = first;
+  } else {
+    queue->head = first;
+  }
+  queue->tail = last;
+}
+
+
+int queue_dequeue_n(struct queue* queue, int* values, int n) {
+  assert(queue && n >= 0);
+  int dequeued = 0;
+  while (dequeued < n && queue->head) {
+    struct link* link = queue->head;
+    values[dequeued++] = link->value;
+    queue->head = link->next;
+    _queue_put_link(queue, link);
+  }
+  if (!queue->head) {
+    queue->tail = NULL;
+  }
+  return dequeued;
+}
+
+
+void queue_reserve(struct queue* queue, int n) {
+  assert(queue && n >= 0);
+  if (n > queue->free_cap) {
+    queue->free_cap = n;
+  }
+  _queue_stock_links(queue, n);
+}
@@ -64,4 +64,50 @@ int queue_front(struct queue* queue);
  */
 int queue_dequeue(struct queue* queue);
 
+/*
+ * Enqueues a batch of values onto a queue, in order.  This works like
+ * calling queue_enqueue() for each value, but adds the whole batch to the
+ * queue at once.  Once the values are dequeued, the queue keeps no more
+ * memory than if they had been enqueued one at a time: unlike
+ * queue_reserve(), this doesn't raise the limit on memory kept for reuse.
+ *
+ * Memory kept from earlier dequeues is reused first.  The linked-list queue
+ * still allocates each value's link beyond that separately, so a batch
+ * larger than that memory costs one allocation per extra value.  Callers
+ * enqueueing large batches repeatedly should call queue_reserve() once up
+ * front instead.
+ *
+ * Params:
+ *   queue - the queue onto which to enqueue values.  May not be NULL.
+ *   values - the values to enqueue.
+ *   n - the number of values to enqueue.
+ */
+void queue_enqueue_n(struct queue* queue, const int* values, int n);
+
+/*
+ * Dequeues up to n values from a queue into an array, in order.
+ *
+ * Params:
+ *   queue - the queue from which to dequeue values.  May not be NULL.
+ *   values - receives the dequeued values.
+ *   n - the largest number of values to dequeue.
+ *
+ * Return:
+ *   Returns the number of values dequeued, which is less than n only if the
+ *   queue ran out of values.
+ */
+int queue_dequeue_n(struct queue* queue, int* values, int n);
+
+/*
+ * Makes sure a queue can hold n more values than it currently does without
+ * allocating any memory.  A queue keeps the memory of dequeued values for
+ * reuse (up to a limit set when it is compiled), and this limit is raised
+ * as needed so the reserved memory is kept for the life of the queue.
+ *
+ * Params:
+ *   queue - the queue for which to reserve memory.  May not be NULL.
+ *   n - the number of additional values to make room for.
+ */
+void queue_reserve(struct queue* queue, int n);
+
 #endif
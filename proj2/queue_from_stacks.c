@@ -13,6 +13,21 @@
 #include "stack.h"
 #include "queue_from_stacks.h"
 
+/*
+ * The queue keeps s1 as an "inbox" and s2 as an "outbox".  Enqueued values
+ * are pushed onto the inbox.  The outbox holds the oldest values with the
+ * front of the queue on top, and only when it runs dry is the whole inbox
+ * moved over, which reverses it into queue order.  Each value is moved at
+ * most once, so every operation takes amortized constant time.
+ */
+static void _queue_from_stacks_fill_outbox(struct queue_from_stacks* queue) {
+	if (stack_isempty(queue->s2)) {
+		while (!stack_isempty(queue->s1)) {
+			stack_push(queue->s2, stack_pop(queue->s1));
+		}
+	}
+}
+
 /*
  * This function should allocate and initialize all of the memory needed for
  * your queue and return a pointer to the queue structure.
@@ -39,6 +54,7 @@ void queue_from_stacks_free(struct queue_from_stacks* queue) {
 	}
 	stack_free(queue->s1);
 	stack_free(queue->s2);
+	free(queue);
 }
 
 /*
@@ -57,12 +73,7 @@ int queue_from_stacks_isempty(struct queue_from_stacks* queue) {
 		exit(0);
 	}
 
-	if(stack_isempty(queue->s1) == 0) {
-		return 0;
-	}
-	else {
-		return 1;
-	}
+	return stack_isempty(queue->s1) && stack_isempty(queue->s2);
 }
 
 /*
@@ -77,17 +88,8 @@ void queue_from_stacks_enqueue(struct queue_from_stacks* queue, int value) {
 	if ((queue->s1) == NULL) {
 		exit(0);
 	}
-	while (!stack_isempty(queue->s1)) {
-		stack_push(queue->s2, stack_pop(queue->s1));
-	}
 	stack_push(queue->s1, value);
-
-	while (!stack_isempty(queue->s2)) {
-		stack_push(queue->s1, stack_pop(queue->s2));
-	}
-		
 }
-	
 
 
 /*
@@ -103,13 +105,11 @@ void queue_from_stacks_enqueue(struct queue_from_stacks* queue, int value) {
  *   Should return the value stored at the front of the queue.
  */
 int queue_from_stacks_front(struct queue_from_stacks* queue) {
-	/*if ((queue->s1) == NULL) {
+	if ((queue->s1) == NULL || queue_from_stacks_isempty(queue)) {
 		exit(0);
 	}
-	int f = stack_top(queue->s1);*/
-	//return stack_top(queue->s1);
-	int f = stack_top(queue->s1);
-	return f;
+	_queue_from_stacks_fill_outbox(queue);
+	return stack_top(queue->s2);
 }
 
 /*
@@ -125,7 +125,9 @@ int queue_from_stacks_front(struct queue_from_stacks* queue) {
  *   is dequeued.
  */
 int queue_from_stacks_dequeue(struct queue_from_stacks* queue) {
-
-
-  return stack_pop(queue->s1);
+	if ((queue->s1) == NULL || queue_from_stacks_isempty(queue)) {
+		exit(0);
+	}
+	_queue_from_stacks_fill_outbox(queue);
+	return stack_pop(queue->s2);
 }
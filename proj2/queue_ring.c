@@ -0,0 +1,171 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a queue using a growable ring buffer.  It implements the same interface as
+ * queue.c and can be used in its place (see the Makefile).
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+
+#include "queue.h"
+
+/*
+ * The capacity of a new queue.  Capacities are always powers of 2, so that
+ * wrapping an index around the end of the buffer is a bitwise and.
+ */
+#define QUEUE_INIT_CAPACITY 16
+
+/*
+ * The largest capacity of a queue, which is the largest power of 2 an int can
+ * hold.  Capacities are only doubled while they are below it.
+ */
+#define QUEUE_MAX_CAPACITY (INT_MAX / 2 + 1)
+
+/*
+ * This is the definition of the queue structure.  The values in the queue
+ * occupy size consecutive slots of data starting at index head, wrapping
+ * around the end of the buffer.
+ */
+struct queue {
+  int* data;
+  int capacity;
+  int head;
+  int size;
+};
+
+
+/*
+ * Auxilliary function to move the values of a queue into a new buffer of a
+ * given capacity.  The front value ends up in slot 0.
+ */
+static void _queue_resize(struct queue* queue, int new_capacity) {
+  assert(new_capacity >= queue->size);
+  int* new_data = malloc(new_capacity * sizeof(int));
+  assert(new_data);
+
+  /*
+   * The values may wrap around the end of the old buffer, in which case
+   * they're copied in two pieces.
+   */
+  if (queue->size > 0) {
+    int first = queue->capacity - queue->head;
+    if (first > queue->size) {
+      first = queue->size;
+    }
+    memcpy(new_data, queue->data + queue->head, first * sizeof(int));
+    memcpy(new_data + first, queue->data,
+      (queue->size - first) * sizeof(int));
+  }
+
+  free(queue->data);
+  queue->data = new_data;
+  queue->capacity = new_capacity;
+  queue->head = 0;
+}
+
+
+struct queue* queue_create() {
+  struct queue* queue = malloc(sizeof(struct queue));
+  assert(queue);
+  queue->data = malloc(QUEUE_INIT_CAPACITY * sizeof(int));
+  assert(queue->data);
+  queue->capacity = QUEUE_INIT_CAPACITY;
+  queue->head = 0;
+  queue->size = 0;
+  return queue;
+}
+
+
+void queue_free(struct queue* queue) {
+  assert(queue);
+  free(queue->data);
+  free(queue);
+}
+
+
+int queue_isempty(struct queue* queue) {
+  assert(queue);
+  return queue->size == 0;
+}
+
+
+void queue_enqueue(struct queue* queue, int value) {
+  assert(queue);
+  if (queue->size == queue->capacity) {
+    assert(queue->capacity < QUEUE_MAX_CAPACITY);
+    _queue_resize(queue, 2 * queue->capacity);
+  }
+  queue->data[(queue->head + queue->size) & (queue->capacity - 1)] = value;
+  queue->size++;
+}
+
+
+int queue_front(struct queue* queue) {
+  assert(queue && queue->size > 0);
+  return queue->data[queue->head];
+}
+
+
+int queue_dequeue(struct queue* queue) {
+  assert(queue && queue->size > 0);
+  int value = queue->data[queue->head];
+  queue->head = (queue->head + 1) & (queue->capacity - 1);
+  queue->size--;
+  return value;
+}
+
+
+void queue_enqueue_n(struct queue* queue, const int* values, int n) {
+  assert(queue && n >= 0);
+  if (n == 0) {
+    return;
+  }
+  queue_reserve(queue, n);
+
+  /*
+   * Copy the batch in, in two pieces if it wraps around the end.
+   */
+  int start = (queue->head + queue->size) & (queue->capacity - 1);
+  int first = queue->capacity - start;
+  if (first > n) {
+    first = n;
+  }
+  memcpy(queue->data + start, values, first * sizeof(int));
+  memcpy(queue->data, values + first, (n - first) * sizeof(int));
+  queue->size += n;
+}
+
+
+int queue_dequeue_n(struct queue* queue, int* values, int n) {
+  assert(queue && n >= 0);
+  if (n > queue->size) {
+    n = queue->size;
+  }
+  if (n == 0) {
+    return 0;
+  }
+
+  int first = queue->capacity - queue->head;
+  if (first > n) {
+    first = n;
+  }
+  memcpy(values, queue->data + queue->head, first * sizeof(int));
+  memcpy(values + first, queue->data, (n - first) * sizeof(int));
+  queue->head = (queue->head + n) & (queue->capacity - 1);
+  queue->size -= n;
+  return n;
+}
+
+
+void queue_reserve(struct queue* queue, int n) {
+  assert(queue && n >= 0 && n <= QUEUE_MAX_CAPACITY - queue->size);
+  int capacity = queue->capacity;
+  while (capacity - queue->size < n) {
+    capacity *= 2;
+  }
+  if (capacity != queue->capacity) {
+    _queue_resize(queue, capacity);
+  }
+}
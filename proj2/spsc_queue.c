@@ -0,0 +1,171 @@
+/*
+ * This file contains the definitions of structures and functions implementing
+ * a bounded single-producer/single-consumer ring queue.
+ *
+ * head and tail count the values ever dequeued and enqueued; a value's slot
+ * is its count modulo the capacity.  Only the consumer writes head and only
+ * the producer writes tail, so each side publishes its progress with a
+ * single release store and no read-modify-write is ever needed.  Each side
+ * also keeps a private copy of the other side's index and only reloads the
+ * shared one when that copy says the queue is full (or empty), which keeps
+ * the two cache lines from bouncing back and forth on every operation.
+ */
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <assert.h>
+
+#include "spsc_queue.h"
+
+#define SPSC_CACHE_LINE 64
+
+/*
+ * This is the definition of the queue structure.  The consumer's fields,
+ * the producer's fields, and the fields neither changes each get their own
+ * cache line.
+ */
+struct spsc_queue {
+  _Alignas(SPSC_CACHE_LINE) _Atomic size_t head;
+  size_t cached_tail;
+  _Alignas(SPSC_CACHE_LINE) _Atomic size_t tail;
+  size_t cached_head;
+  _Alignas(SPSC_CACHE_LINE) int* data;
+  size_t mask;
+};
+
+
+/*
+ * Auxilliary functions to copy n values into or out of the ring, starting at
+ * count pos.  The copy is split in two where it wraps around the end.
+ */
+static void _spsc_copy_in(struct spsc_queue* queue, size_t pos,
+    const int* values, int n) {
+  size_t start = pos & queue->mask;
+  size_t first = queue->mask + 1 - start;
+  if (first > (size_t)n) {
+    first = n;
+  }
+  memcpy(queue->data + start, values, first * sizeof(int));
+  memcpy(queue->data, values + first, (n - first) * sizeof(int));
+}
+
+static void _spsc_copy_out(struct spsc_queue* queue, size_t pos, int* values,
+    int n) {
+  size_t start = pos & queue->mask;
+  size_t first = queue->mask + 1 - start;
+  if (first > (size_t)n) {
+    first = n;
+  }
+  memcpy(values, queue->data + start, first * sizeof(int));
+  memcpy(values + first, queue->data, (n - first) * sizeof(int));
+}
+
+
+struct spsc_queue* spsc_queue_create(int capacity) {
+  assert(capacity > 0);
+  size_t size = 1;
+  while (size < (size_t)capacity) {
+    size *= 2;
+  }
+
+  struct spsc_queue* queue =
+    aligned_alloc(SPSC_CACHE_LINE, sizeof(struct spsc_queue));
+  assert(queue);
+  queue->data = malloc(size * sizeof(int));
+  assert(queue->data);
+  queue->mask = size - 1;
+  atomic_init(&queue->head, 0);
+  atomic_init(&queue->tail, 0);
+  queue->cached_head = queue->cached_tail = 0;
+  return queue;
+}
+
+
+void spsc_queue_free(struct spsc_queue* queue) {
+  assert(queue);
+  free(queue->data);
+  free(queue);
+}
+
+
+int spsc_queue_isempty(struct spsc_queue* queue) {
+  assert(queue);
+  return atomic_load_explicit(&queue->head, memory_order_acquire) ==
+    atomic_load_explicit(&queue->tail, memory_order_acquire);
+}
+
+
+int spsc_queue_enqueue(struct spsc_queue* queue, int value) {
+  return spsc_queue_enqueue_n(queue, &value, 1);
+}
+
+
+int spsc_queue_enqueue_n(struct spsc_queue* queue, const int* values, int n) {
+  assert(queue && n >= 0);
+  size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+  size_t capacity = queue->mask + 1;
+
+  /*
+   * Only look at the consumer's index if our copy of it says there isn't
+   * room for everything.
+   */
+  size_t room = capacity - (tail - queue->cached_head);
+  if (room < (size_t)n) {
+    queue->cached_head =
+      atomic_load_explicit(&queue->head, memory_order_acquire);
+    room = capacity - (tail - queue->cached_head);
+  }
+  if ((size_t)n > room) {
+    n = (int)room;
+  }
+
+  _spsc_copy_in(queue, tail, values, n);
+  atomic_store_explicit(&queue->tail, tail + n, memory_order_release);
+  return n;
+}
+
+
+int spsc_queue_front(struct spsc_queue* queue, int* value) {
+  assert(queue && value);
+  size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+  if (head == queue->cached_tail) {
+    queue->cached_tail =
+      atomic_load_explicit(&queue->tail, memory_order_acquire);
+    if (head == queue->cached_tail) {
+      return 0;
+    }
+  }
+  *value = queue->data[head & queue->mask];
+  return 1;
+}
+
+
+int spsc_queue_dequeue(struct spsc_queue* queue, int* value) {
+  return spsc_queue_dequeue_n(queue, value, 1);
+}
+
+
+int spsc_queue_dequeue_n(struct spsc_queue* queue, int* values, int n) {
+  assert(queue && n >= 0);
+  size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+  /*
+   * Only look at the producer's index if our copy of it says there aren't
+   * enough values.
+   */
+  size_t available = queue->cached_tail - head;
+  if (available < (size_t)n) {
+    queue->cached_tail =
+      atomic_load_explicit(&queue->tail, memory_order_acquire);
+    available = queue->cached_tail - head;
+  }
+  if ((size_t)n > available) {
+    n = (int)available;
+  }
+
+  _spsc_copy_out(queue, head, values, n);
+  atomic_store_explicit(&queue->head, head + n, memory_order_release);
+  return n;
+}
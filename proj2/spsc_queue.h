@@ -0,0 +1,111 @@
+/*
+ * This file contains the definition of an interface for a bounded queue
+ * shared by exactly two threads: one that only enqueues (the producer) and
+ * one that only dequeues (the consumer).  Neither thread ever waits for the
+ * other.
+ */
+
+#ifndef __SPSC_QUEUE_H
+#define __SPSC_QUEUE_H
+
+/*
+ * Structure used to represent a single-producer/single-consumer queue.
+ */
+struct spsc_queue;
+
+/*
+ * Creates a new, empty queue and returns a pointer to it.
+ *
+ * Params:
+ *   capacity - the largest number of values the queue must hold.  This is
+ *     rounded up to a power of 2.  Must be greater than 0.
+ */
+struct spsc_queue* spsc_queue_create(int capacity);
+
+/*
+ * Free all of the memory associated with a queue.  Neither thread may be
+ * using the queue.
+ *
+ * Params:
+ *   queue - the queue to be destroyed.  May not be NULL.
+ */
+void spsc_queue_free(struct spsc_queue* queue);
+
+/*
+ * Returns 1 if the given queue is empty or 0 otherwise.  Called from the
+ * consumer, the answer stays valid until the consumer dequeues; called from
+ * the producer, it may already be out of date.
+ *
+ * Params:
+ *   queue - the queue whose emptiness is to be checked.  May not be NULL.
+ */
+int spsc_queue_isempty(struct spsc_queue* queue);
+
+/*
+ * Enqueue a new value onto a queue.  May only be called by the producer.
+ *
+ * Params:
+ *   queue - the queue onto which to enqueue a value.  May not be NULL.
+ *   value - the new value to be enqueued onto the queue
+ *
+ * Return:
+ *   Returns 1 if the value was enqueued or 0 if the queue was full.
+ */
+int spsc_queue_enqueue(struct spsc_queue* queue, int value);
+
+/*
+ * Enqueues as many values from an array as fit, in order.  May only be
+ * called by the producer.
+ *
+ * Params:
+ *   queue - the queue onto which to enqueue values.  May not be NULL.
+ *   values - the values to enqueue.
+ *   n - the number of values in the array.
+ *
+ * Return:
+ *   Returns the number of values enqueued, which are the first ones in the
+ *   array.
+ */
+int spsc_queue_enqueue_n(struct spsc_queue* queue, const int* values, int n);
+
+/*
+ * Reads a queue's front value without removing that value from the queue.
+ * May only be called by the consumer.
+ *
+ * Params:
+ *   queue - the queue from which to read the front value.  May not be NULL.
+ *   value - receives the front value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was read or 0 if the queue was empty.
+ */
+int spsc_queue_front(struct spsc_queue* queue, int* value);
+
+/*
+ * Removes the front element from a queue.  May only be called by the
+ * consumer.
+ *
+ * Params:
+ *   queue - the queue from which to dequeue a value.  May not be NULL.
+ *   value - receives the dequeued value, if there is one.  May not be NULL.
+ *
+ * Return:
+ *   Returns 1 if a value was dequeued or 0 if the queue was empty.
+ */
+int spsc_queue_dequeue(struct spsc_queue* queue, int* value);
+
+/*
+ * Dequeues up to n values into an array, in order.  May only be called by
+ * the consumer.
+ *
+ * Params:
+ *   queue - the queue from which to dequeue values.  May not be NULL.
+ *   values - receives the dequeued values.
+ *   n - the largest number of values to dequeue.
+ *
+ * Return:
+ *   Returns the number of values dequeued.
+ */
+int spsc_queue_dequeue_n(struct spsc_queue* queue, int* values, int n);
+
+#endif
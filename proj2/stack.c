@@ -1,40 +1,141 @@
 /*
  * This file contains the definitions of structures and functions implementing
- * a simple stack using a linked list.
+ * a stack using an unrolled linked list.  Each node of the list holds a block
+ * of values, so a push or pop only touches the allocator when it crosses a
+ * block boundary.
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
-#include "link.h"
 #include "stack.h"
 
 /*
- * This is the definition of the stack structure.  Using a linked list to
- * implement a stack requires only that we keep track of the top of the stack.
+ * The number of values held by each block.
+ */
+#define STACK_BLOCK_SIZE 64
+
+/*
+ * The number of emptied blocks a stack keeps for reuse by default.  This can
+ * be overridden at compile time.
+ */
+#ifndef STACK_SPARE_BLOCKS
+#define STACK_SPARE_BLOCKS 1
+#endif
+
+/*
+ * This is a block of values.  values[0] is the bottom-most value in the
+ * block.
+ */
+struct stack_block {
+  int values[STACK_BLOCK_SIZE];
+  struct stack_block* next;
+};
+
+/*
+ * This is the definition of the stack structure.  top is the block holding
+ * the top of the stack, and top_count is the number of values in it; every
+ * block below it is full.  The top block is never empty, so the stack is
+ * empty exactly when top is NULL.  spare is a list of up to spare_cap blocks
+ * that were emptied by pops (or set aside by stack_reserve()), so that a
+ * stack going back and forth across a block boundary doesn't allocate and
+ * free a block every time.
  */
 struct stack {
-  struct link* top;
+  struct stack_block* top;
+  int top_count;
+  struct stack_block* spare;
+  int spare_count;
+  int spare_cap;
 };
 
 
+/*
+ * Auxilliary function to start a new, empty top block, reusing a spare block
+ * if we have one.
+ */
+static void _stack_push_block(struct stack* stack) {
+  struct stack_block* block = stack->spare;
+  if (block) {
+    stack->spare = block->next;
+    stack->spare_count--;
+  } else {
+    block = malloc(sizeof(struct stack_block));
+    assert(block);
+  }
+  block->next = stack->top;
+  stack->top = block;
+  stack->top_count = 0;
+}
+
+
+/*
+ * Auxilliary function to unlink the emptied top block, keeping it as a spare
+ * if there is room.  The block below, if any, is full.
+ */
+static void _stack_pop_block(struct stack* stack) {
+  struct stack_block* emptied = stack->top;
+  stack->top = emptied->next;
+  stack->top_count = stack->top ? STACK_BLOCK_SIZE : 0;
+  if (stack->spare_count < stack->spare_cap) {
+    emptied->next = stack->spare;
+    stack->spare = emptied;
+    stack->spare_count++;
+  } else {
+    free(emptied);
+  }
+}
+
+
+/*
+ * Auxilliary function to allocate spare blocks until n more values fit
+ * without allocating, and return the number of spare blocks that takes.
+ * There may then be more than spare_cap spares until enough of them are
+ * used.
+ */
+static int _stack_stock_blocks(struct stack* stack, int n) {
+  /*
+   * Values that fit in the top block need no new blocks.
+   */
+  int room = stack->top ? STACK_BLOCK_SIZE - stack->top_count : 0;
+  int blocks = n > room ? (n - room + STACK_BLOCK_SIZE - 1) / STACK_BLOCK_SIZE
+    : 0;
+
+  while (stack->spare_count < blocks) {
+    struct stack_block* block = malloc(sizeof(struct stack_block));
+    assert(block);
+    block->next = stack->spare;
+    stack->spare = block;
+    stack->spare_count++;
+  }
+  return blocks;
+}
+
+
 struct stack* stack_create() {
   struct stack* stack = malloc(sizeof(struct stack));
   assert(stack);
   stack->top = NULL;
+  stack->top_count = 0;
+  stack->spare = NULL;
+  stack->spare_count = 0;
+  stack->spare_cap = STACK_SPARE_BLOCKS;
   return stack;
 }
 
 
 void stack_free(struct stack* stack) {
   assert(stack);
-
-  /*
-   * Here, we're assuming that stack_pop() handles freeing the memory
-   * associated with each popped element.
-   */
-  while (!stack_isempty(stack)) {
-    stack_pop(stack);
+  while (stack->top) {
+    struct stack_block* block = stack->top;
+    stack->top = block->next;
+    free(block);
+  }
+  while (stack->spare) {
+    struct stack_block* block = stack->spare;
+    stack->spare = block->next;
+    free(block);
   }
   free(stack);
 }
@@ -48,36 +149,91 @@ int stack_isempty(struct stack* stack) {
 
 void stack_push(struct stack* stack, int value) {
   assert(stack);
-  struct link* new_link = malloc(sizeof(struct link));
-  assert(new_link);
 
-  /*
-   * Fill out the new link at put it at the head of the list, which represents
-   * the top of the stack.
-   */
-  new_link->value = value;
-  new_link->next = stack->top;
-  stack->top = new_link;
+  if (!stack->top || stack->top_count == STACK_BLOCK_SIZE) {
+    _stack_push_block(stack);
+  }
+
+  stack->top->values[stack->top_count++] = value;
 }
 
 
 int stack_top(struct stack* stack) {
   assert(stack && stack->top);
-  return stack->top->value;
+  return stack->top->values[stack->top_count - 1];
 }
 
 
 int stack_pop(struct stack* stack) {
   assert(stack && stack->top);
+  int value = stack->top->values[--stack->top_count];
+
+  if (stack->top_count == 0) {
+    _stack_pop_block(stack);
+  }
+
+  return value;
+}
+
+
+void stack_reserve(struct stack* stack, int n) {
+  assert(stack && n >= 0);
+  int blocks = _stack_stock_blocks(stack, n);
+  if (blocks > stack->spare_cap) {
+    stack->spare_cap = blocks;
+  }
+}
+
+
+void stack_push_n(struct stack* stack, const int* values, int n) {
+  assert(stack && n >= 0);
+  _stack_stock_blocks(stack, n);
 
   /*
-   * Remove the old top element from the list and remember its value before
-   * we free it.
+   * Fill the top block, then start new ones as needed.  These all come from
+   * the spares.  Unlike stack_reserve(), this doesn't raise spare_cap, so
+   * the blocks go back to being freed once they are popped.
    */
-  struct link* popped_top = stack->top;
-  int value = popped_top->value;
-  stack->top = popped_top->next;
-  free(popped_top);
+  while (n > 0) {
+    if (!stack->top || stack->top_count == STACK_BLOCK_SIZE) {
+      _stack_push_block(stack);
+    }
+
+    int count = STACK_BLOCK_SIZE - stack->top_count;
+    if (count > n) {
+      count = n;
+    }
+    memcpy(stack->top->values + stack->top_count, values, count * sizeof(int));
+    stack->top_count += count;
+    values += count;
+    n -= count;
+  }
+}
 
-  return value;
+
+int stack_pop_n(struct stack* stack, int* values, int n) {
+  assert(stack && n >= 0);
+  int popped = 0;
+
+  while (popped < n && stack->top) {
+    /*
+     * Take as many values as we need from the top block, topmost first.
+     */
+    int count = stack->top_count;
+    if (count > n - popped) {
+      count = n - popped;
+    }
+    int* src = stack->top->values + stack->top_count;
+    for (int i = 0; i < count; i++) {
+      values[popped + i] = *--src;
+    }
+    popped += count;
+    stack->top_count -= count;
+
+    if (stack->top_count == 0) {
+      _stack_pop_block(stack);
+    }
+  }
+
+  return popped;
 }
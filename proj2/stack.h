@@ -64,4 +64,46 @@ int stack_top(struct stack* stack);
  */
 int stack_pop(struct stack* stack);
 
+/*
+ * Pushes a batch of values onto a stack, in order, so that the last value in
+ * the batch ends up on top.  This works like calling stack_push() for each
+ * value, but allocates any memory needed once and copies values a block at
+ * a time.  Once the values are popped, the stack keeps no more memory than
+ * if they had been pushed one at a time: unlike stack_reserve(), this
+ * doesn't raise the limit on memory kept for reuse.
+ *
+ * Params:
+ *   stack - the stack onto which to push values.  May not be NULL.
+ *   values - the values to push.
+ *   n - the number of values to push.
+ */
+void stack_push_n(struct stack* stack, const int* values, int n);
+
+/*
+ * Pops up to n values off of a stack into an array, in the order they come
+ * off the stack (so values[0] receives the former top value).
+ *
+ * Params:
+ *   stack - the stack from which to pop values.  May not be NULL.
+ *   values - receives the popped values.
+ *   n - the largest number of values to pop.
+ *
+ * Return:
+ *   Returns the number of values popped, which is less than n only if the
+ *   stack ran out of values.
+ */
+int stack_pop_n(struct stack* stack, int* values, int n);
+
+/*
+ * Makes sure a stack can hold n more values than it currently does without
+ * allocating any memory.  A stack keeps a limited amount of the memory freed
+ * up by pops for reuse, and this limit is raised as needed so the reserved
+ * memory is kept for the life of the stack.
+ *
+ * Params:
+ *   stack - the stack for which to reserve memory.  May not be NULL.
+ *   n - the number of additional values to make room for.
+ */
+void stack_reserve(struct stack* stack, int n);
+
 #endif
@@ -13,14 +13,90 @@
 #include "queue.h"
 #include "stack_from_queues.h"
 
+/*
+ * Moves the front value of one queue to the back of another (possibly the
+ * same) queue and returns it.
+ */
+static int _stack_from_queues_move(struct stack_from_queues* stack,
+		struct queue* from, struct queue* to) {
+	int value = queue_dequeue(from);
+	queue_enqueue(to, value);
+	stack->moves++;
+	return value;
+}
+
+/*
+ * Reverses the order of the values in q1, switching the stack between its
+ * two layouts.  With only queue operations, this takes n(n-1)/2 rotations:
+ * each value in turn is rotated to the front of q1 and moved to q2.
+ */
+static void _stack_from_queues_reorient(struct stack_from_queues* stack) {
+	for (int remaining = stack->size; remaining > 0; remaining--) {
+		for (int i = 0; i < remaining - 1; i++) {
+			_stack_from_queues_move(stack, stack->q1, stack->q1);
+		}
+		_stack_from_queues_move(stack, stack->q1, stack->q2);
+	}
+
+	struct queue* tmp = stack->q1;
+	stack->q1 = stack->q2;
+	stack->q2 = tmp;
+	stack->top_last = !stack->top_last;
+	stack->debt = 0;
+}
+
+/*
+ * Updates an adaptive stack's cost model after an operation that cost (or,
+ * if expensive is 0, would have cost in the other layout) n - 1 moves.  Once
+ * the moves spent on expensive operations outweigh those saved on cheap
+ * ones by half the cost of switching layouts, it switches.  Waiting for the
+ * whole cost of switching would never switch back out of the pop-cheap
+ * layout during a run of pushes: the moves those pushes waste grow exactly
+ * as fast as the cost of switching does.
+ */
+static void _stack_from_queues_adapt(struct stack_from_queues* stack,
+		int expensive) {
+	if (stack->mode != STACK_FROM_QUEUES_ADAPTIVE || stack->size < 2) {
+		return;
+	}
+
+	long long n = stack->size;
+	stack->debt += expensive ? n - 1 : -(n - 1);
+	if (stack->debt < 0) {
+		stack->debt = 0;
+	}
+	if (stack->debt >= n * (n - 1) / 4) {
+		_stack_from_queues_reorient(stack);
+	}
+}
+
 /*
  * This function should allocate and initialize all of the memory needed for
- * your stack and return a pointer to the stack structure.
+ * your stack and return a pointer to the stack structure.  The stack uses the
+ * adaptive strategy.
  */
 struct stack_from_queues* stack_from_queues_create() {
+	return stack_from_queues_create_mode(STACK_FROM_QUEUES_ADAPTIVE);
+}
+
+/*
+ * Works like stack_from_queues_create(), but lets the caller choose the
+ * strategy the stack uses.
+ *
+ * Params:
+ *   mode - the strategy to use.
+ */
+struct stack_from_queues* stack_from_queues_create_mode(
+		enum stack_from_queues_mode mode) {
 	struct stack_from_queues * sq = malloc(sizeof(*sq));
 	sq->q1 = queue_create();
 	sq->q2 = queue_create();
+	sq->mode = mode;
+	sq->top_last = mode != STACK_FROM_QUEUES_POP_CHEAP;
+	sq->size = 0;
+	sq->top = 0;
+	sq->moves = 0;
+	sq->debt = 0;
 	return sq;
 }
 
@@ -38,6 +114,7 @@ void stack_from_queues_free(struct stack_from_queues* stack) {
 	}
 	queue_free(stack->q1);
 	queue_free(stack->q2);
+	free(stack);
 }
 
 /*
@@ -55,13 +132,7 @@ int stack_from_queues_isempty(struct stack_from_queues* stack) {
 	if ((stack->q1) == NULL) {
 		exit(0);
 	}
-
-	if (queue_isempty(stack->q1) == 0) {
-		return 0;
-	}
-	else {
-		return 1;
-	}
+	return stack->size == 0;
 }
 
 /*
@@ -73,31 +144,24 @@ int stack_from_queues_isempty(struct stack_from_queues* stack) {
  *   value - the new value to be pushed onto the stack
  */
 void stack_from_queues_push(struct stack_from_queues* stack, int value) {
-	//printf("first time.\n");
-	/*while (queue_isempty(stack->q1) != 1) {
-		printf("while loop used.\n");
-		queue_enqueue(stack->q1, queue_dequeue(stack->q2));
-	}*/
-	//printf("enqueue.\n");
-
-	if (stack_from_queues_isempty(stack)) {
-		queue_enqueue(stack->q1, value);
+	if ((stack->q1) == NULL) {
+		exit(0);
 	}
-	else{
-		while (!queue_isempty(stack->q1)) {
-			queue_enqueue(stack->q2, queue_front(stack->q1));
-			queue_dequeue(stack->q1);
-		}
-		queue_enqueue(stack->q1, value);
 
-		while (!queue_isempty(stack->q2)) {
-			queue_enqueue(stack->q1, queue_front(stack->q2));
-			queue_dequeue(stack->q2);
+	/*
+	 * With the top at the back, the new value just goes behind the others.
+	 * With the top at the front, the others are rotated behind it.
+	 */
+	queue_enqueue(stack->q1, value);
+	if (!stack->top_last) {
+		for (int i = 0; i < stack->size; i++) {
+			_stack_from_queues_move(stack, stack->q1, stack->q1);
 		}
-		
 	}
-	//queue_enqueue(stack->q1, value);
+	stack->top = value;
+	stack->size++;
 
+	_stack_from_queues_adapt(stack, !stack->top_last);
 }
 
 /*
@@ -113,8 +177,10 @@ void stack_from_queues_push(struct stack_from_queues* stack, int value) {
  *   Should return the value stored at the top of the stack.
  */
 int stack_from_queues_top(struct stack_from_queues* stack) {
-	int f = queue_front(stack->q1);
-	return f;
+	if ((stack->q1) == NULL || stack->size == 0) {
+		exit(0);
+	}
+	return stack->top;
 }
 
 /*
@@ -130,17 +196,49 @@ int stack_from_queues_top(struct stack_from_queues* stack) {
  *   is popped.
  */
 int stack_from_queues_pop(struct stack_from_queues* stack) {
-	/*
-	while (!queue_isempty(stack->q1)) {
-		queue_enqueue(stack->q2, queue_dequeue(stack->q1));
-	}*/
+	if ((stack->q1) == NULL || stack->size == 0) {
+		exit(0);
+	}
 
-	int pc = queue_dequeue(stack->q1);
 	/*
-	while (!queue_isempty(stack->q1)) {
-		queue_enqueue(stack->q2, queue_dequeue(stack->q1));
-	}*/
+	 * Account for the pop before the stack shrinks, so the cost model sees
+	 * the moves it takes.
+	 */
+	_stack_from_queues_adapt(stack, stack->top_last);
+
+	int pc;
+	if (stack->top_last) {
+		/*
+		 * Move everything but the top value over to q2; the last value moved
+		 * is the new top.  Then q2 becomes q1.
+		 */
+		for (int i = 0; i < stack->size - 1; i++) {
+			stack->top = _stack_from_queues_move(stack, stack->q1, stack->q2);
+		}
+		pc = queue_dequeue(stack->q1);
 
+		struct queue* tmp = stack->q1;
+		stack->q1 = stack->q2;
+		stack->q2 = tmp;
+	} else {
+		pc = queue_dequeue(stack->q1);
+		if (!queue_isempty(stack->q1)) {
+			stack->top = queue_front(stack->q1);
+		}
+	}
+	stack->size--;
 
-  return pc;
+	return pc;
+}
+
+/*
+ * Returns the number of times a stack has moved a value from the front of a
+ * queue to the back of a queue, which is the main cost of a stack built from
+ * queues.
+ *
+ * Params:
+ *   stack - the stack whose moves are to be counted.  May not be NULL.
+ */
+long long stack_from_queues_moves(struct stack_from_queues* stack) {
+	return stack->moves;
 }
@@ -8,13 +8,48 @@
 
 #include "queue.h"
 
+/*
+ * These are the strategies a stack-from-queues can use.  A stack built from
+ * queues must pay for the mismatch between LIFO and FIFO order on either
+ * push or pop:
+ *
+ *   * PUSH_CHEAP keeps the top value at the back of the queue.  Pushes are
+ *     O(1) and pops move every other value to the second queue, O(n).
+ *   * POP_CHEAP keeps the top value at the front of a single queue.  Pops
+ *     are O(1) and pushes rotate every other value behind the new one, O(n).
+ *   * ADAPTIVE starts out push-cheap and switches between the two layouts
+ *     when the operations it sees would have been cheaper in the other one
+ *     by more than half the O(n^2) cost of switching.  Counting every move
+ *     since the stack was created, including those spent filling it, this
+ *     keeps it within a constant factor of the better fixed layout: close to
+ *     it under a steady mix of operations, and a few times it in the worst
+ *     case.
+ *
+ * stack_from_queues_create() uses ADAPTIVE.  Before the strategies were
+ * added it always behaved like POP_CHEAP.
+ */
+enum stack_from_queues_mode {
+  STACK_FROM_QUEUES_PUSH_CHEAP,
+  STACK_FROM_QUEUES_POP_CHEAP,
+  STACK_FROM_QUEUES_ADAPTIVE
+};
+
 /*
  * This is the definition of the structure you'll use to implement a stack
- * using two queues.
+ * using two queues.  top_last says which layout q1 is currently in, and top
+ * caches the top value so that reading it is always O(1).  moves counts the
+ * values moved from the front of a queue to the back of one, and debt the
+ * moves an adaptive stack has spent beyond what the other layout would have.
  */
 struct stack_from_queues {
   struct queue* q1;
   struct queue* q2;
+  enum stack_from_queues_mode mode;
+  int top_last;
+  int size;
+  int top;
+  long long moves;
+  long long debt;
 };
 
 
@@ -24,11 +59,13 @@ struct stack_from_queues {
  * documentation in stack_from_queues.c for more details about each function.
  */
 struct stack_from_queues* stack_from_queues_create();
+struct stack_from_queues* stack_from_queues_create_mode(
+    enum stack_from_queues_mode mode);
 void stack_from_queues_free(struct stack_from_queues* stack);
 int stack_from_queues_isempty(struct stack_from_queues* stack);
 void stack_from_queues_push(struct stack_from_queues* stack, int value);
 int stack_from_queues_top(struct stack_from_queues* stack);
 int stack_from_queues_pop(struct stack_from_queues* stack);
+long long stack_from_queues_moves(struct stack_from_queues* stack);
 
 #endif
-
@@ -7,6 +7,9 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
 
 #include "acutest.h"
 
@@ -16,6 +19,10 @@
 #include "list_reverse.h"
 #include "queue_from_stacks.h"
 #include "stack_from_queues.h"
+#include "lfstack.h"
+#include "lfqueue.h"
+#include "spsc_queue.h"
+#include "mpmc_queue.h"
 
 /*
  * These are prototypes for auxilliary functions used in some of the tests.
@@ -592,6 +599,896 @@ void test_stack_from_queues_push_multiple() {
 }
 
 
+/*
+ * This function specifies a unit test for the stack-from-queues strategies.
+ * For each strategy, it runs a mix of pushes and pops and makes sure that
+ * the values match those of a regular stack.
+ */
+void test_stack_from_queues_modes() {
+  enum stack_from_queues_mode modes[] = {
+    STACK_FROM_QUEUES_PUSH_CHEAP,
+    STACK_FROM_QUEUES_POP_CHEAP,
+    STACK_FROM_QUEUES_ADAPTIVE
+  };
+  int m, i, v, top, popped;
+
+  for (m = 0; m < 3; m++) {
+    struct stack_from_queues* sfq = stack_from_queues_create_mode(modes[m]);
+    struct stack* s = stack_create();
+
+    /*
+     * Grow the stack in bursts of pushes separated by a few pops, then
+     * drain it.
+     */
+    for (i = 0; i < 400; i++) {
+      if (i % 5 == 4 && !stack_isempty(s)) {
+        v = stack_pop(s);
+        popped = stack_from_queues_pop(sfq);
+        TEST_CHECK_(popped == v, "mode %d: popped value is correct (%d == %d)",
+          m, popped, v);
+      } else {
+        stack_push(s, i);
+        stack_from_queues_push(sfq, i);
+      }
+    }
+    while (!stack_isempty(s)) {
+      v = stack_pop(s);
+      top = stack_from_queues_top(sfq);
+      popped = stack_from_queues_pop(sfq);
+      TEST_CHECK_(top == v, "mode %d: top value is correct (%d == %d)", m,
+        top, v);
+      TEST_CHECK_(popped == v, "mode %d: popped value is correct (%d == %d)",
+        m, popped, v);
+    }
+    TEST_CHECK_(stack_from_queues_isempty(sfq),
+      "mode %d: sfq is empty after popping", m);
+
+    stack_from_queues_free(sfq);
+    stack_free(s);
+  }
+}
+
+
+/*
+ * Auxilliary function to run a push-heavy workload on a stack-from-queues
+ * using a given strategy and return the number of moves it took.
+ */
+long long stack_from_queues_push_heavy_moves(enum stack_from_queues_mode mode) {
+  struct stack_from_queues* sfq = stack_from_queues_create_mode(mode);
+  long long moves;
+  int i, j;
+
+  for (i = 0; i < 50; i++) {
+    for (j = 0; j < 10; j++) {
+      stack_from_queues_push(sfq, j);
+    }
+    stack_from_queues_pop(sfq);
+  }
+  moves = stack_from_queues_moves(sfq);
+  stack_from_queues_free(sfq);
+  return moves;
+}
+
+
+/*
+ * Auxilliary function to fill a stack-from-queues using a given strategy
+ * with fill values, pop pops of them, and then push pushes more.  It
+ * returns the total number of moves, and sets *top_last to the stack's
+ * layout after the pops.
+ */
+long long stack_from_queues_phase_moves(enum stack_from_queues_mode mode,
+    int fill, int pops, int pushes, int* top_last) {
+  struct stack_from_queues* sfq = stack_from_queues_create_mode(mode);
+  long long moves;
+  int i;
+
+  for (i = 0; i < fill; i++) {
+    stack_from_queues_push(sfq, i);
+  }
+  for (i = 0; i < pops; i++) {
+    stack_from_queues_pop(sfq);
+  }
+  *top_last = sfq->top_last;
+  for (i = 0; i < pushes; i++) {
+    stack_from_queues_push(sfq, i);
+  }
+  moves = stack_from_queues_moves(sfq);
+  stack_from_queues_free(sfq);
+  return moves;
+}
+
+
+/*
+ * Auxilliary function returning the smaller of the moves the push-cheap and
+ * pop-cheap strategies take on the workload of
+ * stack_from_queues_phase_moves().
+ */
+long long stack_from_queues_best_phase_moves(int fill, int pops, int pushes) {
+  int top_last;
+  long long push_cheap = stack_from_queues_phase_moves(
+    STACK_FROM_QUEUES_PUSH_CHEAP, fill, pops, pushes, &top_last);
+  long long pop_cheap = stack_from_queues_phase_moves(
+    STACK_FROM_QUEUES_POP_CHEAP, fill, pops, pushes, &top_last);
+  return push_cheap < pop_cheap ? push_cheap : pop_cheap;
+}
+
+
+/*
+ * This function specifies a unit test for the stack-from-queues move
+ * counter.  It checks the moves taken by pushes under the push-cheap and
+ * pop-cheap strategies, then makes sure that the adaptive strategy takes no
+ * more than twice the moves of the better fixed strategy on a push-heavy
+ * workload with occasional pops, on a pop-heavy workload that makes it
+ * switch to the pop-cheap layout, and on a burst of pushes after that
+ * switch, which must make it switch back.
+ */
+void test_stack_from_queues_moves() {
+  struct stack_from_queues* push_cheap =
+    stack_from_queues_create_mode(STACK_FROM_QUEUES_PUSH_CHEAP);
+  struct stack_from_queues* pop_cheap =
+    stack_from_queues_create_mode(STACK_FROM_QUEUES_POP_CHEAP);
+  long long moves, best, adaptive;
+  int i, n = 100, top_last;
+
+  for (i = 0; i < n; i++) {
+    stack_from_queues_push(push_cheap, i);
+    stack_from_queues_push(pop_cheap, i);
+  }
+  moves = stack_from_queues_moves(push_cheap);
+  TEST_CHECK_(moves == 0, "push-cheap pushes move nothing (%lld)", moves);
+  moves = stack_from_queues_moves(pop_cheap);
+  TEST_CHECK_(moves == n * (n - 1) / 2,
+    "pop-cheap pushes rotate the queue (%lld == %d)", moves, n * (n - 1) / 2);
+
+  stack_from_queues_free(push_cheap);
+  stack_from_queues_free(pop_cheap);
+
+  best = stack_from_queues_push_heavy_moves(STACK_FROM_QUEUES_PUSH_CHEAP);
+  moves = stack_from_queues_push_heavy_moves(STACK_FROM_QUEUES_POP_CHEAP);
+  if (moves < best) {
+    best = moves;
+  }
+  adaptive = stack_from_queues_push_heavy_moves(STACK_FROM_QUEUES_ADAPTIVE);
+  TEST_CHECK_(adaptive <= 2 * best,
+    "adaptive moves are within twice the best (%lld <= 2 * %lld)", adaptive,
+    best);
+
+  best = stack_from_queues_best_phase_moves(100, 60, 0);
+  adaptive = stack_from_queues_phase_moves(STACK_FROM_QUEUES_ADAPTIVE, 100,
+    60, 0, &top_last);
+  TEST_CHECK_(!top_last, "adaptive switches to pop-cheap while popping");
+  TEST_CHECK_(adaptive <= 2 * best,
+    "pop-heavy adaptive moves are within twice the best (%lld <= 2 * %lld)",
+    adaptive, best);
+
+  best = stack_from_queues_best_phase_moves(50, 40, 2000);
+  adaptive = stack_from_queues_phase_moves(STACK_FROM_QUEUES_ADAPTIVE, 50,
+    40, 2000, &top_last);
+  TEST_CHECK_(adaptive <= 2 * best,
+    "push burst adaptive moves are within twice the best (%lld <= 2 * %lld)",
+    adaptive, best);
+}
+
+/****************************************************************************
+ **
+ ** stack tests
+ **
+ ****************************************************************************/
+
+
+/*
+ * This function specifies a unit test for the stack.  It pushes enough
+ * values to fill several of the blocks the stack stores its values in, then
+ * makes sure that every value comes back out in LIFO order.  Along the way,
+ * it pushes and pops repeatedly across a block boundary.
+ */
+void test_stack_many_values() {
+  struct stack* s = stack_create();
+  int popped, top, v, i, n = 1000;
+
+  for (i = 0; i < n; i++) {
+    stack_push(s, 3 * i);
+  }
+
+  /*
+   * Pop down to the value at index 576, which is the first one in its block,
+   * and bounce across that block boundary.
+   */
+  for (i = n - 1; i > 576; i--) {
+    stack_pop(s);
+  }
+  for (i = 0; i < 10; i++) {
+    v = stack_pop(s);
+    TEST_CHECK_(v == 3 * 576, "popped value is correct (%d == %d)", v,
+      3 * 576);
+    stack_push(s, v);
+  }
+  for (i = 577; i < n; i++) {
+    stack_push(s, 3 * i);
+  }
+
+  for (i = n - 1; i >= 0; i--) {
+    top = stack_top(s);
+    popped = stack_pop(s);
+    TEST_CHECK_(top == 3 * i, "top value is correct (%d == %d)", top, 3 * i);
+    TEST_CHECK_(popped == 3 * i, "popped value is correct (%d == %d)",
+      popped, 3 * i);
+  }
+
+  /*
+   * Make sure the stack is empty after popping every value.
+   */
+  TEST_CHECK_(stack_isempty(s), "stack is empty after popping");
+
+  stack_free(s);
+}
+
+
+/*
+ * This function specifies a unit test for stack_reserve().  It reserves room
+ * for a number of values on a stack that already holds some, then makes sure
+ * that pushing and popping values still behaves like a stack.
+ */
+void test_stack_reserve() {
+  struct stack* s = stack_create();
+  int popped, i, n = 300;
+
+  stack_push(s, -1);
+  stack_reserve(s, n);
+  for (i = 0; i < n; i++) {
+    stack_push(s, i);
+  }
+  for (i = n - 1; i >= 0; i--) {
+    popped = stack_pop(s);
+    TEST_CHECK_(popped == i, "popped value is correct (%d == %d)", popped, i);
+  }
+
+  popped = stack_pop(s);
+  TEST_CHECK_(popped == -1, "popped value is correct (%d == %d)", popped, -1);
+  TEST_CHECK_(stack_isempty(s), "stack is empty after popping");
+
+  stack_free(s);
+}
+
+
+/*
+ * This function specifies a unit test for stack_push_n() and stack_pop_n().
+ * It mixes batches that span several blocks with single pushes and pops and
+ * makes sure values come back out in LIFO order.
+ */
+void test_stack_batch() {
+  struct stack* s = stack_create();
+  int* values = malloc(1000 * sizeof(int));
+  int* out = malloc(1000 * sizeof(int));
+  int popped, i, n;
+
+  for (i = 0; i < 1000; i++) {
+    values[i] = 7 * i;
+  }
+
+  stack_push(s, -1);
+  stack_push_n(s, values, 300);
+  stack_push(s, -2);
+  stack_push_n(s, values + 300, 10);
+
+  n = stack_pop_n(s, out, 11);
+  TEST_CHECK_(n == 11, "popped 11 values (%d)", n);
+  for (i = 0; i < 10; i++) {
+    TEST_CHECK_(out[i] == 7 * (309 - i), "popped value is correct (%d == %d)",
+      out[i], 7 * (309 - i));
+  }
+  TEST_CHECK_(out[10] == -2, "popped value is correct (%d == -2)", out[10]);
+
+  popped = stack_pop(s);
+  TEST_CHECK_(popped == 7 * 299, "popped value is correct (%d == %d)", popped,
+    7 * 299);
+
+  /*
+   * Ask for more values than are left.
+   */
+  n = stack_pop_n(s, out, 1000);
+  TEST_CHECK_(n == 300, "popped the remaining 300 values (%d)", n);
+  for (i = 0; i < 299; i++) {
+    TEST_CHECK_(out[i] == 7 * (298 - i), "popped value is correct (%d == %d)",
+      out[i], 7 * (298 - i));
+  }
+  TEST_CHECK_(out[299] == -1, "popped value is correct (%d == -1)", out[299]);
+  TEST_CHECK_(stack_isempty(s), "stack is empty after popping");
+
+  free(values);
+  free(out);
+  stack_free(s);
+}
+
+/****************************************************************************
+ **
+ ** queue tests
+ **
+ ****************************************************************************/
+
+
+/*
+ * This function specifies a unit test for queue_reserve().  It reserves room
+ * for a number of values, then repeatedly fills and drains the queue to make
+ * sure that reused memory still gives values back in FIFO order.
+ */
+void test_queue_reserve() {
+  struct queue* q = queue_create();
+  int dequeued, front, round, i, n = 100;
+
+  queue_reserve(q, n);
+  for (round = 0; round < 3; round++) {
+    for (i = 0; i < n; i++) {
+      queue_enqueue(q, round * n + i);
+    }
+    for (i = 0; i < n; i++) {
+      front = queue_front(q);
+      dequeued = queue_dequeue(q);
+      TEST_CHECK_(front == round * n + i, "front value is correct (%d == %d)",
+        front, round * n + i);
+      TEST_CHECK_(dequeued == round * n + i,
+        "dequeued value is correct (%d == %d)", dequeued, round * n + i);
+    }
+    TEST_CHECK_(queue_isempty(q), "queue is empty after dequeueing");
+  }
+
+  queue_free(q);
+}
+
+
+/*
+ * This function specifies a unit test for the queue.  It interleaves
+ * enqueues and dequeues so that the queue keeps growing while its front
+ * moves, then makes sure every value comes back out in FIFO order.
+ */
+void test_queue_interleaved() {
+  struct queue* q = queue_create();
+  int dequeued, next_in = 0, next_out = 0, i;
+
+  for (i = 0; i < 500; i++) {
+    queue_enqueue(q, next_in++);
+    queue_enqueue(q, next_in++);
+    dequeued = queue_dequeue(q);
+    TEST_CHECK_(dequeued == next_out, "dequeued value is correct (%d == %d)",
+      dequeued, next_out);
+    next_out++;
+  }
+  while (!queue_isempty(q)) {
+    dequeued = queue_dequeue(q);
+    TEST_CHECK_(dequeued == next_out, "dequeued value is correct (%d == %d)",
+      dequeued, next_out);
+    next_out++;
+  }
+  TEST_CHECK_(next_out == next_in, "all values were dequeued (%d == %d)",
+    next_out, next_in);
+
+  queue_free(q);
+}
+
+
+/*
+ * This function specifies a unit test for queue_enqueue_n() and
+ * queue_dequeue_n().  It enqueues and dequeues batches of different sizes
+ * so that the queue keeps growing while its front moves, and makes sure
+ * every value comes back out in FIFO order.
+ */
+void test_queue_batch() {
+  struct queue* q = queue_create();
+  int values[37], out[64];
+  int next_in = 0, next_out = 0, i, j, n;
+
+  for (i = 0; i < 100; i++) {
+    for (j = 0; j < 37; j++) {
+      values[j] = next_in++;
+    }
+    queue_enqueue_n(q, values, 37);
+    queue_enqueue(q, next_in++);
+
+    n = queue_dequeue_n(q, out, 25);
+    TEST_CHECK_(n == 25, "dequeued 25 values (%d)", n);
+    for (j = 0; j < n; j++) {
+      TEST_CHECK_(out[j] == next_out, "dequeued value is correct (%d == %d)",
+        out[j], next_out);
+      next_out++;
+    }
+  }
+
+  while ((n = queue_dequeue_n(q, out, 64)) > 0) {
+    for (j = 0; j < n; j++) {
+      TEST_CHECK_(out[j] == next_out, "dequeued value is correct (%d == %d)",
+        out[j], next_out);
+      next_out++;
+    }
+  }
+  TEST_CHECK_(next_out == next_in, "all values were dequeued (%d == %d)",
+    next_out, next_in);
+  TEST_CHECK_(queue_isempty(q), "queue is empty after dequeueing");
+
+  queue_enqueue_n(q, values, 0);
+  queue_enqueue_n(q, NULL, 0);
+  TEST_CHECK_(queue_isempty(q), "queue is empty after an empty batch");
+  n = queue_dequeue_n(q, NULL, 0);
+  TEST_CHECK_(n == 0, "dequeued no values from an empty batch (%d)", n);
+  n = queue_dequeue_n(q, out, 64);
+  TEST_CHECK_(n == 0, "dequeued no values from an empty queue (%d)", n);
+  queue_reserve(q, 1000);
+  TEST_CHECK_(queue_isempty(q), "queue is empty after reserving memory");
+  queue_enqueue(q, 5);
+  TEST_CHECK_(queue_front(q) == 5, "queue works after an empty batch");
+
+  queue_free(q);
+}
+
+
+/****************************************************************************
+ **
+ ** lock-free stack tests
+ **
+ ****************************************************************************/
+
+
+/*
+ * This function specifies a unit test for the lock-free stack used by a
+ * single thread.  It makes sure values come back out in LIFO order and that
+ * popping from an empty stack reports that it is empty.
+ */
+void test_lfstack_single_thread() {
+  struct lfstack* s = lfstack_create();
+  int v, i, n = 200;
+
+  TEST_CHECK_(lfstack_isempty(s), "stack is empty after creation");
+  TEST_CHECK_(!lfstack_pop(s, &v), "popping an empty stack fails");
+
+  for (i = 0; i < n; i++) {
+    lfstack_push(s, i);
+  }
+  for (i = n - 1; i >= 0; i--) {
+    TEST_CHECK_(lfstack_top(s, &v) && v == i, "top value is correct (%d)", i);
+    TEST_CHECK_(lfstack_pop(s, &v) && v == i, "popped value is correct (%d)",
+      i);
+  }
+
+  TEST_CHECK_(lfstack_isempty(s), "stack is empty after popping");
+  TEST_CHECK_(!lfstack_top(s, &v), "reading the top of an empty stack fails");
+
+  lfstack_free(s);
+}
+
+
+#define LF_TEST_THREADS 4
+#define LF_TEST_VALUES 20000
+
+/*
+ * This is the work description for one thread of the concurrent lock-free
+ * tests.  seen counts how many times each value was removed.
+ */
+struct lf_test_worker {
+  pthread_t thread;
+  void* container;
+  int id;
+  atomic_int* seen;
+};
+
+
+/*
+ * Thread entry point that alternates between pushing its own values onto a
+ * lock-free stack and popping whatever is on top.
+ */
+void* lfstack_test_worker(void* arg) {
+  struct lf_test_worker* worker = arg;
+  int v, i;
+  for (i = 0; i < LF_TEST_VALUES; i++) {
+    lfstack_push(worker->container, i * LF_TEST_THREADS + worker->id);
+    if (i % 2 && lfstack_pop(worker->container, &v)) {
+      atomic_fetch_add(&worker->seen[v], 1);
+    }
+  }
+  return NULL;
+}
+
+
+/*
+ * This function specifies a unit test for the lock-free stack shared by
+ * several threads, which push and pop concurrently.  It makes sure that every
+ * value pushed is popped exactly once.
+ */
+void test_lfstack_concurrent() {
+  struct lfstack* s = lfstack_create();
+  struct lf_test_worker workers[LF_TEST_THREADS];
+  int n = LF_TEST_THREADS * LF_TEST_VALUES;
+  atomic_int* seen = calloc(n, sizeof(atomic_int));
+  int v, i, missing = 0;
+
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    workers[i].container = s;
+    workers[i].id = i;
+    workers[i].seen = seen;
+    pthread_create(&workers[i].thread, NULL, lfstack_test_worker,
+      &workers[i]);
+  }
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    pthread_join(workers[i].thread, NULL);
+  }
+  while (lfstack_pop(s, &v)) {
+    seen[v]++;
+  }
+
+  for (i = 0; i < n; i++) {
+    missing += seen[i] != 1;
+  }
+  TEST_CHECK_(missing == 0, "every value was popped exactly once (%d not)",
+    missing);
+
+  free(seen);
+  lfstack_free(s);
+}
+
+
+/****************************************************************************
+ **
+ ** lock-free queue tests
+ **
+ ****************************************************************************/
+
+
+/*
+ * This function specifies a unit test for the lock-free queue used by a
+ * single thread.  It makes sure values come back out in FIFO order and that
+ * dequeueing from an empty queue reports that it is empty.
+ */
+void test_lfqueue_single_thread() {
+  struct lfqueue* q = lfqueue_create();
+  int v, i, n = 200;
+
+  TEST_CHECK_(lfqueue_isempty(q), "queue is empty after creation");
+  TEST_CHECK_(!lfqueue_dequeue(q, &v), "dequeueing an empty queue fails");
+
+  for (i = 0; i < n; i++) {
+    lfqueue_enqueue(q, i);
+    if (i % 3 == 0) {
+      TEST_CHECK_(lfqueue_dequeue(q, &v) && v == i / 3,
+        "dequeued value is correct (%d)", i / 3);
+    }
+  }
+  for (i = (n - 1) / 3 + 1; i < n; i++) {
+    TEST_CHECK_(lfqueue_front(q, &v) && v == i, "front value is correct (%d)",
+      i);
+    TEST_CHECK_(lfqueue_dequeue(q, &v) && v == i,
+      "dequeued value is correct (%d)", i);
+  }
+
+  TEST_CHECK_(lfqueue_isempty(q), "queue is empty after dequeueing");
+  TEST_CHECK_(!lfqueue_front(q, &v),
+    "reading the front of an empty queue fails");
+
+  lfqueue_free(q);
+}
+
+
+/*
+ * Thread entry point that enqueues its own values, in increasing order, into
+ * a lock-free queue.
+ */
+void* lfqueue_test_producer(void* arg) {
+  struct lf_test_worker* worker = arg;
+  for (int i = 0; i < LF_TEST_VALUES; i++) {
+    lfqueue_enqueue(worker->container, i * LF_TEST_THREADS + worker->id);
+  }
+  return NULL;
+}
+
+
+/*
+ * Thread entry point that dequeues from a lock-free queue until every value
+ * has been dequeued by some thread.  The values it gets from any one producer
+ * must come in increasing order; if they don't, the value is counted twice
+ * so the test fails.
+ */
+void* lfqueue_test_consumer(void* arg) {
+  struct lf_test_worker* worker = arg;
+  atomic_int* remaining = &worker->seen[LF_TEST_THREADS * LF_TEST_VALUES];
+  int last[LF_TEST_THREADS];
+  int v, i;
+
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    last[i] = -1;
+  }
+  while (atomic_load(remaining) > 0) {
+    if (lfqueue_dequeue(worker->container, &v)) {
+      int producer = v % LF_TEST_THREADS;
+      atomic_fetch_add(&worker->seen[v], v > last[producer] ? 1 : 2);
+      last[producer] = v;
+      atomic_fetch_sub(remaining, 1);
+    }
+  }
+  return NULL;
+}
+
+
+/*
+ * This function specifies a unit test for the lock-free queue shared by
+ * several producer and consumer threads.  It makes sure that every value
+ * enqueued is dequeued exactly once and that each producer's values are
+ * dequeued in the order it enqueued them.
+ */
+void test_lfqueue_concurrent() {
+  struct lfqueue* q = lfqueue_create();
+  struct lf_test_worker producers[LF_TEST_THREADS];
+  struct lf_test_worker consumers[LF_TEST_THREADS];
+  int n = LF_TEST_THREADS * LF_TEST_VALUES;
+  atomic_int* seen = calloc(n + 1, sizeof(atomic_int));
+  int i, missing = 0;
+
+  atomic_store(&seen[n], n);
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    producers[i].container = consumers[i].container = q;
+    producers[i].id = consumers[i].id = i;
+    producers[i].seen = consumers[i].seen = seen;
+    pthread_create(&consumers[i].thread, NULL, lfqueue_test_consumer,
+      &consumers[i]);
+    pthread_create(&producers[i].thread, NULL, lfqueue_test_producer,
+      &producers[i]);
+  }
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    pthread_join(producers[i].thread, NULL);
+    pthread_join(consumers[i].thread, NULL);
+  }
+
+  for (i = 0; i < n; i++) {
+    missing += seen[i] != 1;
+  }
+  TEST_CHECK_(missing == 0,
+    "every value was dequeued once and in order (%d not)", missing);
+  TEST_CHECK_(lfqueue_isempty(q), "queue is empty after dequeueing");
+
+  free(seen);
+  lfqueue_free(q);
+}
+
+
+/****************************************************************************
+ **
+ ** single-producer/single-consumer queue tests
+ **
+ ****************************************************************************/
+
+
+/*
+ * This function specifies a unit test for the SPSC queue used by a single
+ * thread.  It makes sure that the queue holds exactly its capacity, that
+ * single and batch operations see values in FIFO order, and that batches
+ * wrap around the end of the ring correctly.
+ */
+void test_spsc_queue_single_thread() {
+  struct spsc_queue* q = spsc_queue_create(6);
+  int values[8], out[8];
+  int v, i, n;
+
+  for (i = 0; i < 8; i++) {
+    values[i] = 10 + i;
+  }
+
+  TEST_CHECK_(spsc_queue_isempty(q), "queue is empty after creation");
+  TEST_CHECK_(!spsc_queue_dequeue(q, &v), "dequeueing an empty queue fails");
+
+  /*
+   * The capacity is rounded up to 8.
+   */
+  n = spsc_queue_enqueue_n(q, values, 5);
+  TEST_CHECK_(n == 5, "batch of 5 was enqueued (%d)", n);
+  n = spsc_queue_enqueue_n(q, values + 5, 3);
+  TEST_CHECK_(n == 3, "batch of 3 was enqueued (%d)", n);
+  TEST_CHECK_(!spsc_queue_enqueue(q, 99), "enqueueing into a full queue fails");
+
+  TEST_CHECK_(spsc_queue_front(q, &v) && v == 10, "front value is correct");
+  TEST_CHECK_(spsc_queue_dequeue(q, &v) && v == 10,
+    "dequeued value is correct");
+  n = spsc_queue_dequeue_n(q, out, 4);
+  TEST_CHECK_(n == 4 && out[0] == 11 && out[3] == 14,
+    "batch of 4 was dequeued in order");
+
+  /*
+   * This batch wraps around the end of the ring, and only 5 of 6 values fit.
+   */
+  n = spsc_queue_enqueue_n(q, values, 6);
+  TEST_CHECK_(n == 5, "batch was cut to the free space (%d == 5)", n);
+  n = spsc_queue_dequeue_n(q, out, 8);
+  TEST_CHECK_(n == 8, "every value was dequeued (%d == 8)", n);
+  for (i = 0; i < 3; i++) {
+    TEST_CHECK_(out[i] == 15 + i, "dequeued value is correct (%d == %d)",
+      out[i], 15 + i);
+  }
+  for (i = 3; i < 8; i++) {
+    TEST_CHECK_(out[i] == 7 + i, "dequeued value is correct (%d == %d)",
+      out[i], 7 + i);
+  }
+  TEST_CHECK_(spsc_queue_isempty(q), "queue is empty after dequeueing");
+
+  spsc_queue_free(q);
+}
+
+
+#define SPSC_TEST_VALUES 200000
+
+/*
+ * Thread entry point that enqueues 0 through SPSC_TEST_VALUES - 1 into an
+ * SPSC queue, in batches of varying size.
+ */
+void* spsc_queue_test_producer(void* arg) {
+  struct spsc_queue* q = arg;
+  int batch[37];
+  int next = 0;
+
+  while (next < SPSC_TEST_VALUES) {
+    int n = 1 + next % 37;
+    if (n > SPSC_TEST_VALUES - next) {
+      n = SPSC_TEST_VALUES - next;
+    }
+    for (int i = 0; i < n; i++) {
+      batch[i] = next + i;
+    }
+    n = spsc_queue_enqueue_n(q, batch, n);
+    if (n == 0) {
+      sched_yield();
+    }
+    next += n;
+  }
+  return NULL;
+}
+
+
+/*
+ * This function specifies a unit test for the SPSC queue shared by a
+ * producer and a consumer thread.  It makes sure that the consumer sees every
+ * value in order.
+ */
+void test_spsc_queue_concurrent() {
+  struct spsc_queue* q = spsc_queue_create(64);
+  pthread_t producer;
+  int out[16];
+  int expected = 0, errors = 0;
+
+  pthread_create(&producer, NULL, spsc_queue_test_producer, q);
+  while (expected < SPSC_TEST_VALUES) {
+    int n = spsc_queue_dequeue_n(q, out, 1 + expected % 16);
+    if (n == 0) {
+      sched_yield();
+    }
+    for (int i = 0; i < n; i++) {
+      errors += out[i] != expected++;
+    }
+  }
+  pthread_join(producer, NULL);
+
+  TEST_CHECK_(errors == 0, "every value was dequeued in order (%d not)",
+    errors);
+  TEST_CHECK_(spsc_queue_isempty(q), "queue is empty after dequeueing");
+
+  spsc_queue_free(q);
+}
+
+
+/****************************************************************************
+ **
+ ** bounded multi-producer/multi-consumer queue tests
+ **
+ ****************************************************************************/
+
+
+/*
+ * This function specifies a unit test for the bounded MPMC queue used by a
+ * single thread.  It makes sure that the queue holds exactly its capacity
+ * and gives values back in FIFO order as its positions wrap around the ring.
+ */
+void test_mpmc_queue_single_thread() {
+  struct mpmc_queue* q = mpmc_queue_create(3);
+  int v, i, round;
+
+  TEST_CHECK_(mpmc_queue_isempty(q), "queue is empty after creation");
+  TEST_CHECK_(!mpmc_queue_try_dequeue(q, &v),
+    "dequeueing an empty queue fails");
+
+  /*
+   * The capacity is rounded up to 4.
+   */
+  for (round = 0; round < 5; round++) {
+    for (i = 0; i < 4; i++) {
+      TEST_CHECK_(mpmc_queue_try_enqueue(q, round * 4 + i),
+        "value %d was enqueued", round * 4 + i);
+    }
+    TEST_CHECK_(!mpmc_queue_try_enqueue(q, -1),
+      "enqueueing into a full queue fails");
+    for (i = 0; i < 3; i++) {
+      TEST_CHECK_(mpmc_queue_try_dequeue(q, &v) && v == round * 4 + i,
+        "dequeued value is correct (%d)", round * 4 + i);
+    }
+    v = mpmc_queue_dequeue(q);
+    TEST_CHECK_(v == round * 4 + 3, "dequeued value is correct (%d == %d)", v,
+      round * 4 + 3);
+    TEST_CHECK_(mpmc_queue_isempty(q), "queue is empty after dequeueing");
+  }
+
+  mpmc_queue_free(q);
+}
+
+
+/*
+ * Thread entry point that enqueues its own values, in increasing order, into
+ * a bounded MPMC queue, waiting whenever the queue is full.
+ */
+void* mpmc_queue_test_producer(void* arg) {
+  struct lf_test_worker* worker = arg;
+  for (int i = 0; i < LF_TEST_VALUES; i++) {
+    mpmc_queue_enqueue(worker->container, i * LF_TEST_THREADS + worker->id);
+  }
+  return NULL;
+}
+
+
+/*
+ * Thread entry point that dequeues LF_TEST_VALUES values from a bounded MPMC
+ * queue, waiting whenever the queue is empty.  As for the lock-free queue
+ * test, a value is counted twice if it arrives out of order.
+ */
+void* mpmc_queue_test_consumer(void* arg) {
+  struct lf_test_worker* worker = arg;
+  int last[LF_TEST_THREADS];
+  int v, i;
+
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    last[i] = -1;
+  }
+  for (i = 0; i < LF_TEST_VALUES; i++) {
+    v = mpmc_queue_dequeue(worker->container);
+    int producer = v % LF_TEST_THREADS;
+    atomic_fetch_add(&worker->seen[v], v > last[producer] ? 1 : 2);
+    last[producer] = v;
+  }
+  return NULL;
+}
+
+
+/*
+ * This function specifies a unit test for a small bounded MPMC queue shared
+ * by several producer and consumer threads, which keep it full or empty much
+ * of the time.  It makes sure that every value enqueued is dequeued exactly
+ * once and that each producer's values are dequeued in the order it
+ * enqueued them.
+ */
+void test_mpmc_queue_concurrent() {
+  struct mpmc_queue* q = mpmc_queue_create(16);
+  struct lf_test_worker producers[LF_TEST_THREADS];
+  struct lf_test_worker consumers[LF_TEST_THREADS];
+  int n = LF_TEST_THREADS * LF_TEST_VALUES;
+  atomic_int* seen = calloc(n, sizeof(atomic_int));
+  int i, missing = 0;
+
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    producers[i].container = consumers[i].container = q;
+    producers[i].id = consumers[i].id = i;
+    producers[i].seen = consumers[i].seen = seen;
+    pthread_create(&consumers[i].thread, NULL, mpmc_queue_test_consumer,
+      &consumers[i]);
+    pthread_create(&producers[i].thread, NULL, mpmc_queue_test_producer,
+      &producers[i]);
+  }
+  for (i = 0; i < LF_TEST_THREADS; i++) {
+    pthread_join(producers[i].thread, NULL);
+    pthread_join(consumers[i].thread, NULL);
+  }
+
+  for (i = 0; i < n; i++) {
+    missing += seen[i] != 1;
+  }
+  TEST_CHECK_(missing == 0,
+    "every value was dequeued once and in order (%d not)", missing);
+  TEST_CHECK_(mpmc_queue_isempty(q), "queue is empty after dequeueing");
+
+  free(seen);
+  mpmc_queue_free(q);
+}
+
+
 TEST_LIST = {
   /* list_reverse() tests */
   { "regular_list_reverse", test_regular_list_reverse },
@@ -605,6 +1502,28 @@ TEST_LIST = {
   { "stack_from_queues_create", test_stack_from_queues_create },
   { "stack_from_queues_push_single", test_stack_from_queues_push_single },
   { "stack_from_queues_push_multiple", test_stack_from_queues_push_multiple },
+  { "stack_from_queues_modes", test_stack_from_queues_modes },
+  { "stack_from_queues_moves", test_stack_from_queues_moves },
+  /* stack tests */
+  { "stack_many_values", test_stack_many_values },
+  { "stack_reserve", test_stack_reserve },
+  { "stack_batch", test_stack_batch },
+  /* queue tests */
+  { "queue_reserve", test_queue_reserve },
+  { "queue_interleaved", test_queue_interleaved },
+  { "queue_batch", test_queue_batch },
+  /* lock-free stack tests */
+  { "lfstack_single_thread", test_lfstack_single_thread },
+  { "lfstack_concurrent", test_lfstack_concurrent },
+  /* lock-free queue tests */
+  { "lfqueue_single_thread", test_lfqueue_single_thread },
+  { "lfqueue_concurrent", test_lfqueue_concurrent },
+  /* single-producer/single-consumer queue tests */
+  { "spsc_queue_single_thread", test_spsc_queue_single_thread },
+  { "spsc_queue_concurrent", test_spsc_queue_concurrent },
+  /* bounded multi-producer/multi-consumer queue tests */
+  { "mpmc_queue_single_thread", test_mpmc_queue_single_thread },
+  { "mpmc_queue_concurrent", test_mpmc_queue_concurrent },
   { NULL, NULL }
 };
 